@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <print>
+#include <string_view>
+#include "TSCClock.h"
+#include "Utils.h"
+
+// Keeps a value alive without letting the compiler reason about it.
+template<typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Runs `body` once to warm up, then `rounds` times, and prints the best per-op time.
+template<typename BodyT>
+inline double benchNs(std::string_view name, size_t opsPerRound, int rounds, BodyT&& body) {
+    body();
+
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < rounds; ++r) {
+        uint64_t start = rdtsc();
+        body();
+        uint64_t cycles = rdtsc() - start;
+        if (cycles < best) best = cycles;
+    }
+
+    double ns = TSCClock::get().toNanos(best) / static_cast<double>(opsPerRound);
+    std::println("  {:<36} {:>8.2f} ns/op", name, ns);
+    return ns;
+}
+
+// Same, with `reset` run untimed before every round, for bodies that change their input.
+template<typename BodyT, typename ResetT>
+inline double benchNs(std::string_view name, size_t opsPerRound, int rounds, BodyT&& body, ResetT&& reset) {
+    reset();
+    body();
+
+    uint64_t best = UINT64_MAX;
+    for (int r = 0; r < rounds; ++r) {
+        reset();
+        uint64_t start = rdtsc();
+        body();
+        uint64_t cycles = rdtsc() - start;
+        if (cycles < best) best = cycles;
+    }
+
+    double ns = TSCClock::get().toNanos(best) / static_cast<double>(opsPerRound);
+    std::println("  {:<36} {:>8.2f} ns/op", name, ns);
+    return ns;
+}
@@ -0,0 +1,157 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <print>
+#include <random>
+#include <span>
+#include <vector>
+#include "BenchUtils.h"
+#include "lob/BboBitset.h"
+
+// BboBitset against the two obvious alternatives, on one bid side of a realistic book:
+// a few dozen to a few hundred populated levels clustered around the touch of a wide
+// price grid, updated mostly near the touch.
+
+constexpr int32_t MAX_PRICE = 100000;
+constexpr int32_t MID = 50000;
+constexpr size_t OPS = 1 << 16;
+constexpr size_t TOP_K = 10;
+constexpr int ROUNDS = 20;
+
+// Sorted array of populated prices, best bid at the back.
+class SortedLevels {
+    std::vector<int32_t> prices;
+
+public:
+    SortedLevels() { prices.reserve(4096); }
+
+    void setPrice(int32_t p) {
+        auto it = std::lower_bound(prices.begin(), prices.end(), p);
+        if (it == prices.end() || *it != p) prices.insert(it, p);
+    }
+
+    void clearPrice(int32_t p) {
+        auto it = std::lower_bound(prices.begin(), prices.end(), p);
+        if (it != prices.end() && *it == p) prices.erase(it);
+    }
+
+    int32_t getBestBid() const { return prices.empty() ? 0 : prices.back(); }
+
+    size_t topBids(std::span<int32_t> out) const {
+        size_t n = std::min(out.size(), prices.size());
+        std::copy_n(prices.rbegin(), n, out.begin());
+        return n;
+    }
+};
+
+// Single-level bitmap: O(1) updates, scans word by word for the best and the next level.
+class FlatBitmap {
+    static constexpr size_t WORDS = MAX_PRICE / 64 + 1;
+    std::vector<uint64_t> words = std::vector<uint64_t>(WORDS);
+
+    int32_t highestFrom(int64_t q) const {
+        if (q < 0) return -1;
+        auto i = static_cast<size_t>(q / 64);
+        uint64_t m = words[i] & (~UINT64_C(0) >> (63 - (q & 63)));
+
+        while (!m) {
+            if (i == 0) return -1;
+            m = words[--i];
+        }
+        return static_cast<int32_t>(i * 64 + std::bit_width(m) - 1);
+    }
+
+public:
+    void setPrice(int32_t p) { words[p / 64] |= UINT64_C(1) << (p & 63); }
+    void clearPrice(int32_t p) { words[p / 64] &= ~(UINT64_C(1) << (p & 63)); }
+
+    int32_t getBestBid() const {
+        int32_t best = highestFrom(MAX_PRICE);
+        return best < 0 ? 0 : best;
+    }
+
+    size_t topBids(std::span<int32_t> out) const {
+        size_t n = 0;
+        for (int32_t p = highestFrom(MAX_PRICE); p >= 0 && n < out.size(); p = highestFrom(p - 1)) {
+            out[n++] = p;
+        }
+        return n;
+    }
+};
+
+struct BitsetAdapter {
+    BboBitset<MAX_PRICE> bits;
+
+    void setPrice(int32_t p) { bits.setPrice(p); }
+    void clearPrice(int32_t p) { bits.clearPrice(p); }
+    int32_t getBestBid() const { return bits.getBestBid(); }
+    size_t topBids(std::span<int32_t> out) const { return bits.top<Side::Buy>(out); }
+};
+
+struct Op {
+    int32_t price;
+    bool set;
+};
+
+// Levels within `spread` ticks below the mid, touched with a bias towards the touch.
+std::vector<Op> makeOps(int32_t spread, std::mt19937& rng) {
+    std::geometric_distribution<int32_t> depth(4.0 / spread);
+    std::vector<Op> ops(OPS);
+
+    for (Op& op : ops) {
+        op.price = MID - std::min(depth(rng), spread);
+        op.set = rng() & 1;
+    }
+    return ops;
+}
+
+template<typename BookT>
+void run(const char* name, int32_t levels, int32_t spread, const std::vector<Op>& ops) {
+    std::unique_ptr<BookT> book;
+
+    // Back to exactly `levels` populated prices: the updates leave their own behind.
+    auto seed = [&] {
+        book = std::make_unique<BookT>();
+        for (int32_t i = 0; i < levels; ++i) book->setPrice(MID - (i * spread) / levels);
+    };
+
+    std::println(" {}", name);
+
+    benchNs("update (set/clear near touch)", OPS, ROUNDS, [&] {
+        for (const Op& op : ops) {
+            if (op.set) book->setPrice(op.price);
+            else book->clearPrice(op.price);
+        }
+    }, seed);
+
+    seed();
+
+    benchNs("best bid", OPS, ROUNDS, [&] {
+        for (size_t i = 0; i < OPS; ++i) doNotOptimize(book->getBestBid());
+    });
+
+    std::array<int32_t, TOP_K> out;
+    benchNs("top-10 bids", OPS / 16, ROUNDS, [&] {
+        for (size_t i = 0; i < OPS / 16; ++i) {
+            doNotOptimize(book->topBids(out));
+            doNotOptimize(out);
+        }
+    });
+}
+
+int main() {
+    std::mt19937 rng(42);
+    TSCClock::get();
+
+    struct Scenario { int32_t levels; int32_t spread; };
+
+    for (Scenario s : {Scenario{32, 64}, Scenario{256, 2048}, Scenario{2048, 20000}}) {
+        std::println("=== {} levels over {} ticks ===", s.levels, s.spread);
+        std::vector<Op> ops = makeOps(s.spread, rng);
+
+        run<BitsetAdapter>("BboBitset (3 levels)", s.levels, s.spread, ops);
+        run<SortedLevels>("Sorted array", s.levels, s.spread, ops);
+        run<FlatBitmap>("Flat bitmap", s.levels, s.spread, ops);
+    }
+}
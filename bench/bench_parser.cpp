@@ -0,0 +1,90 @@
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <print>
+#include <random>
+#include <vector>
+#include "BenchUtils.h"
+#include "EngineConfig.h"
+#include "net/SimParser.h"
+
+// What SimParser's range checks and slice mapping cost on top of decoding: a
+// feed-like mix of adds, cancels and executions, with and without a share of
+// out-of-range items that take the reject path.
+
+using Profile = ThinVenueProfile;
+
+constexpr size_t PACKETS = 1 << 14;
+constexpr size_t SLOT = 64;
+constexpr int ROUNDS = 50;
+
+struct Packets {
+    std::vector<char> bytes = std::vector<char>(PACKETS * SLOT);
+    std::vector<uint16_t> lengths = std::vector<uint16_t>(PACKETS);
+};
+
+template<typename MsgT>
+void put(Packets& packets, size_t i, MsgT msg) {
+    std::memcpy(packets.bytes.data() + i * SLOT, &msg, sizeof(msg));
+    packets.lengths[i] = sizeof(msg);
+}
+
+// 60% adds, 30% cancels, 10% executions. `invalidPct` percent get an instrument or
+// price past the profile.
+Packets makePackets(unsigned invalidPct, std::mt19937& rng) {
+    Packets packets;
+
+    for (size_t i = 0; i < PACKETS; ++i) {
+        bool invalid = rng() % 100 < invalidPct;
+        unsigned kind = rng() % 10;
+
+        Sim::PacketHeader header{};
+        header.seqNum = std::byteswap(static_cast<uint64_t>(i + 1));
+        header.instrumentId = std::byteswap(static_cast<uint16_t>(invalid ? Profile::MAX_INSTRUMENTS + 1 : rng() % Profile::MAX_INSTRUMENTS));
+        uint64_t id = std::byteswap(static_cast<uint64_t>(rng() % Profile::MAX_ORDER_IDS));
+
+        if (kind < 6) {
+            header.type = MsgType::AddOrder;
+            int32_t price = invalid ? -1 : static_cast<int32_t>(1 + rng() % (Profile::MAX_PRICE - 1));
+            put(packets, i, Sim::AddOrderMsg{header, id, std::byteswap(price), std::byteswap(static_cast<uint32_t>(1 + rng() % 1000)), rng() & 1 ? 'B' : 'S'});
+        }
+        else if (kind < 9) {
+            header.type = MsgType::CancelOrder;
+            put(packets, i, Sim::CancelOrderMsg{header, id});
+        }
+        else {
+            header.type = MsgType::ExecutedOrder;
+            put(packets, i, Sim::ExecutedOrderMsg{header, id, std::byteswap(static_cast<uint32_t>(1 + rng() % 100))});
+        }
+    }
+    return packets;
+}
+
+template<bool Validated>
+void run(const char* name, const Packets& packets) {
+    SimParser<Profile> parser;
+    QueueItem item{};
+
+    benchNs(name, PACKETS, ROUNDS, [&] {
+        for (size_t i = 0; i < PACKETS; ++i) {
+            const char* packet = packets.bytes.data() + i * SLOT;
+            bool ok = Validated ? parser.parse(packet, packets.lengths[i], &item)
+                                : parser.parseUnchecked(packet, packets.lengths[i], &item);
+            doNotOptimize(ok);
+            doNotOptimize(item);
+        }
+    });
+}
+
+int main() {
+    std::mt19937 rng(42);
+    TSCClock::get();
+
+    for (unsigned invalidPct : {0u, 1u, 10u}) {
+        std::println("=== {}% out-of-range items ===", invalidPct);
+        Packets packets = makePackets(invalidPct, rng);
+
+        run<false>("decode only", packets);
+        run<true>("decode + validate + map", packets);
+    }
+}
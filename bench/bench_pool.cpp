@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <print>
+#include <random>
+#include <vector>
+#include "BenchUtils.h"
+#include "lob/Order.h"
+#include "lob/OrderPool.h"
+
+// Order churn through the split pool (OrderLinks + OrderInfo) against the single array of
+// Order it replaced. Both go through the same level lists: adds link at the tail, cancels
+// unlink from the middle (touching both neighbours), executions shrink an order in place.
+// The book is prefilled untimed before every round so each one starts from the same state.
+
+constexpr size_t POOL_SIZE = 1 << 20;
+constexpr size_t LIVE = 1 << 18;
+constexpr size_t OPS = 1 << 20;
+constexpr int32_t PRICES = 2048;
+constexpr int ROUNDS = 10;
+
+// The pool before the split: everything about an order in one 32-byte struct.
+class AosPool {
+    std::vector<Order> store;
+    int32_t freeHead = 0;
+
+public:
+    explicit AosPool(size_t size) : store(size) {
+        for (size_t i = 0; i < size - 1; ++i) store[i].next = static_cast<int32_t>(i + 1);
+        store[size - 1].next = -1;
+    }
+
+    int32_t allocate(uint64_t id, int32_t price, uint32_t quantity, Side side) {
+        int32_t idx = freeHead;
+        freeHead = store[idx].next;
+        store[idx] = Order(id, price, quantity, side, 0);
+        return idx;
+    }
+
+    void deallocate(int32_t idx) {
+        store[idx].next = freeHead;
+        freeHead = idx;
+    }
+
+    int32_t& prev(int32_t idx) { return store[idx].prev; }
+    int32_t& next(int32_t idx) { return store[idx].next; }
+    uint32_t& quantity(int32_t idx) { return store[idx].quantity; }
+    int32_t price(int32_t idx) const { return store[idx].price; }
+    Side side(int32_t idx) const { return store[idx].side; }
+};
+
+struct SoaPool {
+    OrderPool pool;
+
+    explicit SoaPool(size_t size) : pool(size) {}
+
+    int32_t allocate(uint64_t id, int32_t price, uint32_t quantity, Side side) {
+        return pool.allocate(id, price, quantity, side, 0);
+    }
+
+    void deallocate(int32_t idx) { pool.deallocate(idx); }
+
+    int32_t& prev(int32_t idx) { return pool.link(idx).prev; }
+    int32_t& next(int32_t idx) { return pool.link(idx).next; }
+    uint32_t& quantity(int32_t idx) { return pool.link(idx).quantity; }
+    int32_t price(int32_t idx) { return pool.link(idx).price; }
+    Side side(int32_t idx) const { return pool.info(idx).side; }
+};
+
+struct Op {
+    enum Kind : uint8_t { Add, Cancel, Execute } kind;
+    Side side;
+    int32_t price;
+    uint32_t quantity;
+    uint64_t id;
+};
+
+template<typename PoolT>
+class Book {
+    struct Level {
+        int32_t head = -1;
+        int32_t tail = -1;
+        uint64_t volume = 0;
+    };
+
+    PoolT pool{POOL_SIZE};
+    std::vector<Level> levels = std::vector<Level>(2 * PRICES);
+    std::vector<int32_t> index;
+
+    Level& levelOf(Side side, int32_t price) { return levels[(side == Side::Sell) * PRICES + price]; }
+
+public:
+    explicit Book(size_t ids) : index(ids, -1) {}
+
+    void apply(const Op& op) {
+        switch (op.kind) {
+            case Op::Add: {
+                int32_t idx = pool.allocate(op.id, op.price, op.quantity, op.side);
+                index[op.id] = idx;
+
+                Level& level = levelOf(op.side, op.price);
+                if (level.tail == -1) level.head = idx;
+                else {
+                    pool.next(level.tail) = idx;
+                    pool.prev(idx) = level.tail;
+                }
+                level.tail = idx;
+                level.volume += op.quantity;
+                break;
+            }
+            case Op::Cancel: {
+                int32_t idx = index[op.id];
+                Level& level = levelOf(pool.side(idx), pool.price(idx));
+                int32_t prev = pool.prev(idx);
+                int32_t next = pool.next(idx);
+
+                if (prev != -1) pool.next(prev) = next;
+                else level.head = next;
+                if (next != -1) pool.prev(next) = prev;
+                else level.tail = prev;
+
+                level.volume -= pool.quantity(idx);
+                index[op.id] = -1;
+                pool.deallocate(idx);
+                break;
+            }
+            case Op::Execute: {
+                int32_t idx = index[op.id];
+                uint32_t& qty = pool.quantity(idx);
+                uint32_t executed = std::min(qty, op.quantity);
+                qty -= executed;
+                levelOf(pool.side(idx), pool.price(idx)).volume -= executed;
+                break;
+            }
+        }
+    }
+};
+
+// LIVE adds to prefill, then OPS of churn keeping the book near LIVE orders:
+// half adds, a third cancels of a random live order, the rest partial executions.
+std::vector<Op> makeOps(std::mt19937_64& rng, uint64_t& nextId) {
+    std::vector<Op> ops;
+    std::vector<uint64_t> live;
+
+    auto add = [&] {
+        auto side = (rng() & 1) ? Side::Buy : Side::Sell;
+        ops.push_back({Op::Add, side, static_cast<int32_t>(rng() % PRICES), static_cast<uint32_t>(1 + rng() % 100), nextId});
+        live.push_back(nextId++);
+    };
+
+    for (size_t i = 0; i < LIVE; ++i) add();
+
+    while (ops.size() < LIVE + OPS) {
+        unsigned kind = rng() % 6;
+        if (kind < 3 || live.empty()) {
+            add();
+        }
+        else {
+            size_t j = rng() % live.size();
+            if (kind < 5) {
+                ops.push_back({Op::Cancel, Side::Buy, 0, 0, live[j]});
+                live[j] = live.back();
+                live.pop_back();
+            }
+            else {
+                ops.push_back({Op::Execute, Side::Buy, 0, 1, live[j]});
+            }
+        }
+    }
+    return ops;
+}
+
+template<typename PoolT>
+void run(const char* name, const std::vector<Op>& ops, uint64_t ids) {
+    std::unique_ptr<Book<PoolT>> book;
+
+    benchNs(name, OPS, ROUNDS, [&] {
+        for (size_t i = LIVE; i < ops.size(); ++i) book->apply(ops[i]);
+    }, [&] {
+        book = std::make_unique<Book<PoolT>>(ids);
+        for (size_t i = 0; i < LIVE; ++i) book->apply(ops[i]);
+    });
+}
+
+int main() {
+    std::mt19937_64 rng(42);
+    TSCClock::get();
+
+    uint64_t ids = 0;
+    std::vector<Op> ops = makeOps(rng, ids);
+
+    std::println("=== {} ops over ~{} live orders, {} prices per side ===", OPS, LIVE, PRICES);
+    run<AosPool>("Order array (before the split)", ops, ids);
+    run<SoaPool>("OrderLinks + OrderInfo", ops, ids);
+}
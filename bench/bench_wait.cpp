@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <thread>
+#include <vector>
+#include "RingBuffer.h"
+#include "TSCClock.h"
+#include "Utils.h"
+#include "WaitStrategy.h"
+
+// Wake-up latency of each wait strategy: a producer publishes one timestamp after a gap
+// long enough for the consumer to have gone idle (spun out, armed UMWAIT or parked),
+// the consumer records publish-to-seen time. Run with the two threads on separate
+// physical cores: bench_wait <consumer core> <producer core>.
+
+constexpr size_t SAMPLES = 2000;
+constexpr auto GAP = std::chrono::milliseconds(1);
+
+using Ring = RingBuffer<uint64_t, 1024>;
+
+template<typename WaitT>
+void run(const char* name, int consumerCore, int producerCore) {
+    auto ring = std::make_unique<Ring>();
+    std::vector<uint64_t> cycles;
+    cycles.reserve(SAMPLES);
+
+    std::thread consumer([&] {
+        pin_to_core(consumerCore);
+        WaitT wait;
+
+        while (cycles.size() < SAMPLES) {
+            uint64_t* stamp = ring->peek();
+            if (!stamp) {
+                wait.idle(*ring);
+                continue;
+            }
+            uint64_t now = rdtsc();
+            wait.reset();
+
+            cycles.push_back(now - *stamp);
+            ring->advance();
+        }
+    });
+
+    std::thread producer([&] {
+        pin_to_core(producerCore);
+
+        for (size_t i = 0; i < SAMPLES; ++i) {
+            std::this_thread::sleep_for(GAP);
+            ring->push(rdtsc());
+            ring->wake();
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    std::sort(cycles.begin(), cycles.end());
+    const TSCClock& clock = TSCClock::get();
+    std::println("  {:<14} p50 {:>10.0f} ns   p99 {:>10.0f} ns   max {:>10.0f} ns", name,
+                 clock.toNanos(cycles[SAMPLES / 2]), clock.toNanos(cycles[SAMPLES * 99 / 100]), clock.toNanos(cycles.back()));
+}
+
+int main(int argc, char* argv[]) {
+    int consumerCore = argc > 1 ? std::atoi(argv[1]) : 2;
+    int producerCore = argc > 2 ? std::atoi(argv[2]) : 3;
+    TSCClock::get();
+
+    std::println("=== Wake-up latency, {} samples, {} us between publishes (WAITPKG: {}) ===",
+                 SAMPLES, std::chrono::microseconds(GAP).count(), cpu_has_waitpkg() ? "yes" : "no");
+
+    run<BusySpinWait>("BusySpinWait", consumerCore, producerCore);
+    run<UmwaitWait<>>("UmwaitWait", consumerCore, producerCore);
+    run<FutexWait<>>("FutexWait", consumerCore, producerCore);
+}
@@ -0,0 +1,63 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "EngineConfig.h"
+#include "lob/Listeners.h"
+#include "lob/MarketManager.h"
+#include "net/SimParser.h"
+
+// Arbitrary bytes through the parser and into the book. Whatever the parser accepts must
+// be safe to apply, so a sanitizer report inside MarketManager is a validation gap too.
+//
+// Input: one byte picking the feed slice, then packets, each prefixed with a one-byte
+// length. Accepted items go to the engine in batches, as from the ring.
+
+using Profile = ThinVenueProfile;
+
+constexpr size_t MAX_BATCH = 32;
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    if (size == 0) return 0;
+
+    // Whole engine, single feed, or one of two sliced feeds.
+    uint8_t feeds = (data[0] % 3 == 0) ? 1 : 2;
+    uint8_t feed = (data[0] % 3 == 2) ? 1 : 0;
+    SimParser<Profile> parser(feedSlice<Profile>(feed, feeds));
+
+    // One engine for the whole run, reset before each input: building one per input cost
+    // more than the input itself. The reset restores the constructed state, so crashes
+    // still reproduce from the input alone.
+    static EmptyListener listener;
+    static auto market = std::make_unique<MarketManager<EmptyListener, Profile>>(listener);
+    market->reset();
+
+    std::vector<QueueItem> batch;
+    batch.reserve(MAX_BATCH);
+
+    size_t pos = 1;
+    while (pos < size) {
+        // Two statements: as call arguments, pos++ and size - pos are unsequenced.
+        size_t prefix = data[pos++];
+        size_t len = std::min(prefix, size - pos);
+
+        // The parser reads the packet in place: hand it an exact-size copy so ASan
+        // catches any read past `len`.
+        std::vector<char> packet(data + pos, data + pos + len);
+        pos += len;
+
+        QueueItem item{};
+        if (parser.parse(packet.data(), packet.size(), &item)) {
+            batch.push_back(item);
+        }
+
+        if (batch.size() == MAX_BATCH) {
+            market->onBatch(batch);
+            batch.clear();
+        }
+    }
+
+    market->onBatch(batch);
+    return 0;
+}
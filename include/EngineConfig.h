@@ -0,0 +1,185 @@
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <string>
+#include <string_view>
+#include "Messages.h"
+
+// Compile-time capacities. Every sized structure (books, pool, bitsets, ring) derives
+// from one profile so nothing can drift apart.
+template<size_t Instruments, size_t LiveOrders, size_t OrderIds, int32_t MaxPrice, size_t RingSize, size_t OwnOrders>
+struct EngineProfile
+{
+    static constexpr size_t MAX_INSTRUMENTS = Instruments;
+    static constexpr size_t MAX_LIVE_ORDERS = LiveOrders;
+    static constexpr size_t MAX_ORDER_IDS = OrderIds;
+    static constexpr int32_t MAX_PRICE = MaxPrice;
+    static constexpr size_t RING_SIZE = RingSize;
+    static constexpr size_t MAX_OWN_ORDERS = OwnOrders; // tracked queue positions, and pending reports
+};
+
+template<typename P>
+concept EngineProfileConcept = requires {
+    { P::MAX_INSTRUMENTS } -> std::convertible_to<size_t>;
+    { P::MAX_LIVE_ORDERS } -> std::convertible_to<size_t>;
+    { P::MAX_ORDER_IDS } -> std::convertible_to<size_t>;
+    { P::MAX_PRICE } -> std::convertible_to<int32_t>;
+    { P::RING_SIZE } -> std::convertible_to<size_t>;
+    { P::MAX_OWN_ORDERS } -> std::convertible_to<size_t>;
+};
+
+// Venues with a handful of instruments and a narrow price grid. About 11 MB in all:
+// 5 MB of price levels (8 books x 2 sides x 20001 levels of 16 bytes), 4 MB of id index
+// and 2 MB of pool. It fits a server L3, not L2: the levels near the touch stay hot, the
+// rest of the grid and the index miss like in the busy profile, just less often.
+using ThinVenueProfile = EngineProfile<8, 65'536, 1'000'000, 20'000, 1024, 1024>;
+
+using BusyVenueProfile = EngineProfile<64, 1'000'000, 10'000'000, 100'000, 4096, 8192>;
+
+using DefaultProfile = BusyVenueProfile;
+
+// The part of the engine's instrument and order-id space one feed maps into, so feeds
+// sharing an engine can't collide on ids: the feed's own instrument i becomes
+// instrumentBase + i, its order id n becomes idBase + n.
+struct FeedSlice
+{
+    uint8_t feedId;
+    uint16_t instrumentBase;
+    uint16_t instrumentCount;
+    uint64_t idBase;
+    uint64_t idCount;
+};
+
+// Slice `feed` of `feeds` equal shares.
+template<EngineProfileConcept ProfileT>
+constexpr FeedSlice feedSlice(uint8_t feed = 0, uint8_t feeds = 1)
+{
+    uint16_t instruments = static_cast<uint16_t>(ProfileT::MAX_INSTRUMENTS / feeds);
+    uint64_t ids = ProfileT::MAX_ORDER_IDS / feeds;
+    return {feed, static_cast<uint16_t>(feed * instruments), instruments, feed * ids, ids};
+}
+
+// Runtime topology: what to run and where.
+struct RuntimeConfig
+{
+    std::string mode = "live";
+    std::string profile = "busy";
+    int networkCore = 4;
+    int engineCore = 5;
+
+    bool verify = false;
+    int verifierCore = 6;
+
+    // Live: record the tap to this file (instead of --verify). Replay: read it back.
+    std::string capturePath;
+    int captureCore = 6;
+
+    // Split deployment: "feed" and "engine" processes sharing a named ring in /dev/shm.
+    std::string shmName;
+    uint16_t port = 1234;
+
+    // Second feed multiplexed on the network core, polled less often than the primary. 0: none.
+    uint16_t auxPort = 0;
+
+    // Feeds sharing the engine each map into their own slice of instruments and order ids:
+    // the primary feed takes slice feedIndex of feedCount, the aux feed the next one. In a
+    // split deployment every process passes the same --feed-count.
+    uint8_t feedIndex = 0;
+    uint8_t feedCount = 1;
+
+    // Start mid-session from the snapshot channel instead of empty books.
+    bool lateJoin = false;
+    uint16_t snapshotPort = 1235;
+};
+
+inline RuntimeConfig parseRuntimeConfig(int argc, char* argv[])
+{
+    RuntimeConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--profile" && hasValue) {
+            config.profile = argv[++i];
+        }
+        else if (arg == "--net-core" && hasValue) {
+            config.networkCore = std::atoi(argv[++i]);
+        }
+        else if (arg == "--engine-core" && hasValue) {
+            config.engineCore = std::atoi(argv[++i]);
+        }
+        else if (arg == "--verify") {
+            config.verify = true;
+        }
+        else if (arg == "--verify-core" && hasValue) {
+            config.verifierCore = std::atoi(argv[++i]);
+        }
+        else if (arg == "--capture" && hasValue) {
+            config.capturePath = argv[++i];
+        }
+        else if (arg == "--capture-core" && hasValue) {
+            config.captureCore = std::atoi(argv[++i]);
+        }
+        else if (arg == "--shm" && hasValue) {
+            config.shmName = argv[++i];
+        }
+        else if (arg == "--port" && hasValue) {
+            config.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--aux-port" && hasValue) {
+            config.auxPort = static_cast<uint16_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--feed-index" && hasValue) {
+            config.feedIndex = static_cast<uint8_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--feed-count" && hasValue) {
+            config.feedCount = static_cast<uint8_t>(std::atoi(argv[++i]));
+        }
+        else if (arg == "--late-join") {
+            config.lateJoin = true;
+        }
+        else if (arg == "--snapshot-port" && hasValue) {
+            config.snapshotPort = static_cast<uint16_t>(std::atoi(argv[++i]));
+        }
+        else if (!arg.starts_with("--")) {
+            config.mode = arg;
+        }
+        else {
+            std::println(stderr, "Unknown option {}", arg);
+        }
+    }
+
+    if (config.profile != "thin" && config.profile != "busy") {
+        std::println(stderr, "Unknown profile {} (thin or busy)", config.profile);
+        exit(EXIT_FAILURE);
+    }
+
+    if (config.verify && !config.capturePath.empty() && config.mode != "replay") {
+        std::println(stderr, "--verify and --capture both need the tap, pick one");
+        exit(EXIT_FAILURE);
+    }
+
+    // The reference book starts empty and never sees the snapshot.
+    if (config.verify && config.lateJoin) {
+        std::println(stderr, "--verify can't follow a --late-join engine, pick one");
+        exit(EXIT_FAILURE);
+    }
+
+    // An aux feed needs a slice of its own.
+    if (config.auxPort != 0 && config.feedCount == 1) {
+        config.feedCount = 2;
+    }
+
+    size_t localFeeds = config.auxPort != 0 ? 2 : 1;
+    if (config.feedCount == 0 || config.feedCount > MAX_FEEDS || config.feedIndex + localFeeds > config.feedCount) {
+        std::println(stderr, "Feed slices {}..{} don't fit in --feed-count {} (max {})",
+                     config.feedIndex, config.feedIndex + localFeeds - 1, config.feedCount, MAX_FEEDS);
+        exit(EXIT_FAILURE);
+    }
+
+    return config;
+}
@@ -1,7 +1,4 @@
 #pragma once
 #include <atomic>
-#include "RingBuffer.h"
-#include "Messages.h"
 
-extern RingBuffer<QueueItem, 4096> ringBuffer;
 extern std::atomic<bool> running;
\ No newline at end of file
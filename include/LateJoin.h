@@ -0,0 +1,129 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <print>
+#include <span>
+#include <vector>
+#include "EngineConfig.h"
+#include "Globals.h"
+#include "Messages.h"
+#include "Validation.h"
+#include "net/SnapshotClient.h"
+
+// Drops incrementals a snapshot already reflects. An instrument is filtered until it
+// shows a seqNum above its snapshot's: stale items can still sit in the ring or the
+// socket buffers after the splice. The snapshot feed numbers all of its instruments in
+// one sequence, so once it passes the newest snapshot seqNum nothing left is stale,
+// even for instruments that have been quiet since.
+class SnapshotFilter {
+private:
+    std::vector<uint64_t> snapshotSeq;
+    uint64_t maxSeq = 0;
+    uint8_t feedId = 0;
+    size_t open = 0;
+
+public:
+    SnapshotFilter() = default;
+    explicit SnapshotFilter(uint8_t feedId) : feedId(feedId) {}
+
+    void set(uint16_t instrId, uint64_t seqNum) {
+        if (seqNum == 0) return;
+        if (instrId >= snapshotSeq.size()) snapshotSeq.resize(instrId + 1, 0);
+
+        if (snapshotSeq[instrId] == 0) ++open;
+        snapshotSeq[instrId] = seqNum;
+        maxSeq = std::max(maxSeq, seqNum);
+    }
+
+    bool active() const { return open != 0; }
+
+    bool stale(const QueueItem& item) {
+        // Execution reports are not in the snapshot, and are numbered apart from the feed.
+        if (open == 0 || item.type == MsgType::OwnOrder) return false;
+
+        if (item.feedId == feedId && item.seqNum > maxSeq) {
+            snapshotSeq.clear();
+            open = 0;
+            return false;
+        }
+
+        if (item.instrumentId >= snapshotSeq.size()) return false;
+
+        uint64_t& seq = snapshotSeq[item.instrumentId];
+        if (seq == 0) return false;
+        if (item.seqNum <= seq) return true;
+
+        seq = 0;
+        --open;
+        return false;
+    }
+};
+
+// Starting mid-session: fetches a snapshot off the engine core while the engine keeps
+// draining the ring into a local buffer, bulk-loads the snapshot, then applies the
+// buffered incrementals the snapshot does not already reflect. The returned filter
+// must keep screening the live stream until it goes inactive. The snapshot channel
+// serves one feed: its orders are mapped into that feed's slice like the parser does.
+template<EngineProfileConcept ProfileT, typename RingT, typename MarketT, typename WaitT>
+SnapshotFilter lateJoin(RingT& ring, MarketT& market, WaitT& wait, SnapshotClient client, const FeedSlice& slice, size_t maxBatch)
+{
+    std::println("[LATE JOIN] Fetching snapshot...");
+    auto pending = std::async(std::launch::async, [&client] { return client.fetch(); });
+
+    std::vector<QueueItem> buffered;
+    buffered.reserve(1 << 16);
+
+    while (running && pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        std::span<QueueItem> batch = ring.peekBatch(maxBatch);
+        if (batch.empty()) {
+            wait.idle(ring);
+            continue;
+        }
+        wait.reset();
+
+        buffered.insert(buffered.end(), batch.begin(), batch.end());
+        ring.advance(batch.size());
+    }
+
+    std::vector<InstrumentSnapshot> snapshots = pending.get();
+
+    // Instruments without a snapshot are not filtered: all of their buffered messages apply.
+    SnapshotFilter filter(slice.feedId);
+    size_t loaded = 0;
+
+    RejectCounters rejects;
+
+    for (InstrumentSnapshot& snap : snapshots) {
+        if (snap.instrumentId >= slice.instrumentCount) {
+            rejects.add(RejectReason::InvalidInstrument);
+            continue;
+        }
+        snap.instrumentId += slice.instrumentBase;
+
+        // Snapshot orders skip the parser: same range checks and mapping before they reach the books.
+        std::erase_if(snap.orders, [&](QueueItem& item) {
+            item.instrumentId = snap.instrumentId;
+            item.id = item.id < slice.idCount ? slice.idBase + item.id : ProfileT::MAX_ORDER_IDS;
+            item.feedId = slice.feedId;
+
+            uint32_t mask = rejectMask<ProfileT>(item);
+            rejects.add(mask);
+            return mask != 0;
+        });
+
+        filter.set(snap.instrumentId, snap.seqNum);
+
+        market.loadSnapshot(snap.instrumentId, snap.seqNum, snap.orders);
+        loaded += snap.orders.size();
+    }
+
+    std::erase_if(buffered, [&](const QueueItem& item) { return filter.stale(item); });
+
+    market.onBatch(buffered);
+
+    std::println("[LATE JOIN] {} instruments, {} orders loaded, {} buffered messages spliced",
+                 snapshots.size(), loaded, buffered.size());
+    rejects.report("LATE JOIN");
+    return filter;
+}
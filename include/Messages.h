@@ -1,11 +1,13 @@
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 enum class MsgType : uint8_t 
 {
     AddOrder = 'A',
     CancelOrder = 'C',
-    ExecutedOrder = 'E'
+    ExecutedOrder = 'E',
+    OwnOrder = 'O' // execution-report stand-in: the order with this id is ours
 };
 
 enum class Side : uint8_t {
@@ -13,6 +15,21 @@ enum class Side : uint8_t {
     Sell = 'S'
 };
 
+enum class RejectReason : uint8_t {
+    DuplicateId,
+    InvalidPrice,
+    InvalidQuantity,
+    OrderNotFound,
+    SystemFull,
+    InvalidInstrument,
+    InvalidSide,
+    Malformed, // truncated packet or unknown message type
+    COUNT
+};
+
+// Feeds that can share one engine; each gets its own slice of instruments and order ids.
+inline constexpr size_t MAX_FEEDS = 4;
+
 struct alignas(32) QueueItem
 {
     uint64_t seqNum;
@@ -22,4 +39,18 @@ struct alignas(32) QueueItem
     uint16_t instrumentId;
     MsgType type;
     Side side;
+    uint8_t feedId; // seqNums are per feed
+};
+
+// Aggregated trade: consecutive passive fills on one instrument and one resting side,
+// within a burst, attributed to a single aggressor.
+struct TradePrint
+{
+    uint64_t seqNum;      // first fill
+    int32_t price;        // first (best) fill price
+    int32_t lastPrice;    // last fill price, differs when the aggressor swept levels
+    uint32_t quantity;
+    uint16_t instrumentId;
+    Side aggressorSide;
+    uint8_t fills;
 };
\ No newline at end of file
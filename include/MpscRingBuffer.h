@@ -0,0 +1,296 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include "RingBuffer.h"
+#include "Utils.h"
+
+// Multi-producer single-consumer variant of RingBuffer with the same claim/publish and
+// peek/advance interface. Each slot has a sequence number: producers reserve a slot
+// with a CAS on head and publish it by bumping its sequence, so one slow producer only
+// holds back the consumer at its own slot. Items stay contiguous for peekBatch.
+//
+// Producers may be separate processes that die at any point. A claimed slot is stamped
+// with its producer's pid; a slot that stalls the consumer for ORPHAN_CYCLES is skipped
+// once its producer is gone (or never got to stamp it), so a crashed feed can't wedge
+// the engine.
+template<typename T, size_t Size>
+class MpscRingBuffer {
+
+    static_assert((Size & (Size -1)) == 0, "Size must be a power of 2");
+
+private:
+    static constexpr size_t mask = Size - 1;
+
+    // Slot sequence for position pos: pos free, pos | CLAIMED being written, pos + 1
+    // published, pos + Size consumed (free for the next lap).
+    static constexpr size_t CLAIMED = size_t(1) << 63;
+
+    // Empty polls between two looks at the stalled slot, and how long it must stall.
+    static constexpr uint32_t ORPHAN_POLLS = 256;
+    static constexpr uint64_t ORPHAN_CYCLES = UINT64_C(1) << 30;
+
+    T buffer[Size];
+    std::atomic<size_t> seqs[Size];
+    std::atomic<int32_t> owners[Size];
+
+    alignas(hardware_destructive_interference_size)
+    std::atomic<size_t> head = {0};
+
+    alignas(hardware_destructive_interference_size)
+    std::atomic<size_t> tail = {0};
+
+    // Consumer only: the slot it is stuck on, if any.
+    size_t stallPos = 0;
+    uint32_t stallPolls = 0;
+    uint64_t stallSince = 0;
+    uint64_t orphans = 0;
+
+    alignas(hardware_destructive_interference_size)
+    RingParker parker;
+
+    bool readable(size_t pos) const
+    {
+        return seqs[pos & mask].load(std::memory_order_acquire) == pos + 1;
+    }
+
+    // getpid() is a syscall: cached, and refreshed in a forked child.
+    static int32_t producerId()
+    {
+        static int32_t pid = [] {
+            pthread_atfork(nullptr, nullptr, [] { pid = static_cast<int32_t>(getpid()); });
+            return static_cast<int32_t>(getpid());
+        }();
+        return pid;
+    }
+
+    static bool alive(int32_t pid)
+    {
+        return pid > 0 && (kill(pid, 0) == 0 || errno == EPERM);
+    }
+
+    // Consumer side, on an empty poll at `pos`: frees the slot for the next lap if it was
+    // reserved and its producer died before publishing it.
+    bool reclaimOrphan(size_t pos)
+    {
+        if (pos != stallPos) {
+            stallPos = pos;
+            stallPolls = 0;
+            stallSince = 0;
+            return false;
+        }
+        if (++stallPolls % ORPHAN_POLLS != 0) [[likely]] return false;
+
+        // Nothing reserved: the ring is just empty.
+        if (head.load(std::memory_order_relaxed) == pos) {
+            stallSince = 0;
+            return false;
+        }
+
+        uint64_t now = rdtsc();
+        if (stallSince == 0) {
+            stallSince = now;
+            return false;
+        }
+        if (now - stallSince < ORPHAN_CYCLES) return false;
+
+        std::atomic<size_t>& seq = seqs[pos & mask];
+        size_t s = seq.load(std::memory_order_acquire);
+
+        // Stamped by a producer that is still running: it is slow, not gone.
+        if (s == (pos | CLAIMED) && alive(owners[pos & mask].load(std::memory_order_relaxed))) return false;
+        if (s != pos && s != (pos | CLAIMED)) return false;
+
+        // A producer that reserved but had not stamped yet fails its stamp and claims again.
+        if (!seq.compare_exchange_strong(s, pos + Size, std::memory_order_acq_rel)) return false;
+
+        tail.store(pos + 1, std::memory_order_relaxed);
+        ++orphans;
+        stallPos = pos + 1;
+        stallPolls = 0;
+        stallSince = 0;
+        return true;
+    }
+
+public:
+    using value_type = T;
+    static constexpr size_t CAPACITY = Size;
+    static constexpr bool MULTI_PRODUCER = true;
+
+    MpscRingBuffer()
+    {
+        for (size_t i = 0; i < Size; ++i) {
+            seqs[i].store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Unlike RingBuffer, a claim reserves the slot: every claimed slot must be published.
+    T* claim()
+    {
+        size_t pos = head.load(std::memory_order_relaxed);
+
+        while (true)
+        {
+            std::atomic<size_t>& seq = seqs[pos & mask];
+            size_t current = seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(current & ~CLAIMED) - static_cast<std::ptrdiff_t>(pos);
+
+            if (diff == 0 && !(current & CLAIMED))
+            {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    // The stamp only fails if the consumer took us for dead and freed the slot.
+                    owners[pos & mask].store(producerId(), std::memory_order_relaxed);
+                    size_t expected = pos;
+                    if (seq.compare_exchange_strong(expected, pos | CLAIMED, std::memory_order_release, std::memory_order_relaxed)) {
+                        return &buffer[pos & mask];
+                    }
+                    pos = head.load(std::memory_order_relaxed);
+                }
+            }
+            else if (diff < 0)
+            {
+                return nullptr;
+            }
+            else
+            {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    void publish(T* slot)
+    {
+        std::atomic<size_t>& seq = seqs[slot - buffer];
+        seq.store((seq.load(std::memory_order_relaxed) & ~CLAIMED) + 1, std::memory_order_release);
+    }
+
+    bool push(const T& item)
+    {
+        T* slot = claim();
+        if (!slot) return false;
+
+        *slot = item;
+        publish(slot);
+        return true;
+    }
+
+    T* peek()
+    {
+        auto current_tail = tail.load(std::memory_order_relaxed);
+        if (!readable(current_tail) && reclaimOrphan(current_tail)) [[unlikely]] {
+            ++current_tail;
+        }
+        return readable(current_tail) ? &buffer[current_tail & mask] : nullptr;
+    }
+
+    bool pop(T& item)
+    {
+        T* slot = peek();
+        if (!slot) return false;
+
+        item = *slot;
+        advance();
+        return true;
+    }
+
+    // Contiguous run of published items, stopping at the first slot still being written.
+    std::span<T> peekBatch(size_t maxItems)
+    {
+        auto current_tail = tail.load(std::memory_order_relaxed);
+        if (!readable(current_tail) && reclaimOrphan(current_tail)) [[unlikely]] {
+            ++current_tail;
+        }
+        size_t limit = std::min(Size - (current_tail & mask), maxItems);
+
+        size_t count = 0;
+        while (count < limit && readable(current_tail + count)) {
+            ++count;
+        }
+
+        return {&buffer[current_tail & mask], count};
+    }
+
+    void advance()
+    {
+        advance(1);
+    }
+
+    void advance(size_t count)
+    {
+        const auto current_tail = tail.load(std::memory_order_relaxed);
+
+        for (size_t pos = current_tail; pos != current_tail + count; ++pos) {
+            seqs[pos & mask].store(pos + Size, std::memory_order_release);
+        }
+
+        tail.store(current_tail + count, std::memory_order_relaxed);
+    }
+
+    // head moves at claim time, before the item is written: waking on it could find the
+    // slot still unpublished. The tail slot's sequence word only changes on publish.
+    const std::atomic<size_t>* monitorWord() const
+    {
+        return &seqs[tail.load(std::memory_order_relaxed) & mask];
+    }
+
+    bool empty() const
+    {
+        return !readable(tail.load(std::memory_order_relaxed));
+    }
+
+    void park(std::chrono::microseconds timeout)
+    {
+        parker.park([this] { return empty(); }, timeout);
+    }
+
+    void wake()
+    {
+        parker.wake();
+    }
+
+    // Slots skipped because their producer died between claim and publish.
+    uint64_t getOrphans() const
+    {
+        return orphans;
+    }
+
+    // Consumer restart on a ring left by a previous run, with producers possibly still
+    // attached: finishes an advance() the old consumer died in (slots already freed past
+    // tail), then checks every slot of the lap against tail. False if they disagree.
+    bool recoverConsumer()
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+
+        while (t != head.load(std::memory_order_acquire)
+               && seqs[t & mask].load(std::memory_order_acquire) == t + Size) {
+            ++t;
+        }
+
+        for (size_t pos = t; pos != t + Size; ++pos) {
+            size_t s = seqs[pos & mask].load(std::memory_order_acquire);
+            if (s != pos && s != (pos | CLAIMED) && s != pos + 1) return false;
+        }
+
+        if (head.load(std::memory_order_acquire) - t > Size) return false;
+
+        tail.store(t, std::memory_order_relaxed);
+        stallPos = t;
+        stallPolls = 0;
+        stallSince = 0;
+        return true;
+    }
+
+    size_t getSize()
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t t = tail.load(std::memory_order_relaxed);
+        return h - t;
+    }
+};
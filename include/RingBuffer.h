@@ -1,7 +1,14 @@
 #pragma once
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <new>
+#include <span>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #ifdef __cpp_lib_hardware_interference_size
     using std::hardware_destructive_interference_size;
@@ -9,6 +16,42 @@
     constexpr size_t hardware_destructive_interference_size = 64;
 #endif
 
+// Futex word a consumer sleeps on (see FutexWait), kept on its own cache line by the
+// owning ring. Uses shared futex ops so it also works for rings mapped into several processes.
+class RingParker {
+private:
+    std::atomic<uint32_t> parked = {0};
+
+public:
+    // Sleeps until wake() or the timeout, unless stillEmpty() turns false once parked is
+    // visible. The timeout bounds the cost of a wake-up lost to the unfenced check in wake().
+    template<typename Pred>
+    void park(Pred stillEmpty, std::chrono::microseconds timeout)
+    {
+        parked.store(1, std::memory_order_seq_cst);
+
+        if (stillEmpty())
+        {
+            struct timespec ts;
+            ts.tv_sec = timeout.count() / 1'000'000;
+            ts.tv_nsec = (timeout.count() % 1'000'000) * 1000;
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&parked), FUTEX_WAIT, 1, &ts, nullptr, 0);
+        }
+
+        parked.store(0, std::memory_order_relaxed);
+    }
+
+    // Producer side: a relaxed load of a line nobody writes unless a consumer is parked.
+    void wake()
+    {
+        if (parked.load(std::memory_order_relaxed)) [[unlikely]]
+        {
+            parked.store(0, std::memory_order_relaxed);
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&parked), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+        }
+    }
+};
+
 template<typename T, size_t Size>
 class RingBuffer {
 
@@ -25,7 +68,14 @@ private:
     alignas(hardware_destructive_interference_size)
     std::atomic<size_t> tail = {0};
 
+    alignas(hardware_destructive_interference_size)
+    RingParker parker;
+
 public:
+    using value_type = T;
+    static constexpr size_t CAPACITY = Size;
+    static constexpr bool MULTI_PRODUCER = false;
+
     RingBuffer() {}
 
     bool push(const T& item)
@@ -63,6 +113,12 @@ public:
         head.store(current_head + 1, std::memory_order_release);
     }
 
+    // Same signature as MpscRingBuffer, so producers can be written against either.
+    void publish(T*)
+    {
+        publish();
+    }
+
     bool pop(T& item)
     {
         const auto current_tail = tail.load(std::memory_order_relaxed);
@@ -98,6 +154,46 @@ public:
         tail.store(current_tail + 1, std::memory_order_release);
     }
 
+    // Contiguous run of readable items (stops at the wrap point), at most maxItems.
+    std::span<T> peekBatch(size_t maxItems)
+    {
+        const auto current_tail = tail.load(std::memory_order_relaxed);
+        const auto current_head = head.load(std::memory_order_acquire);
+
+        size_t available = current_head - current_tail;
+        size_t untilWrap = Size - (current_tail & mask);
+        size_t count = std::min({available, untilWrap, maxItems});
+
+        return {&buffer[current_tail & mask], count};
+    }
+
+    void advance(size_t count)
+    {
+        const auto current_tail = tail.load(std::memory_order_relaxed);
+        tail.store(current_tail + count, std::memory_order_release);
+    }
+
+    // Word written when the next item becomes readable: what UmwaitWait monitors.
+    const std::atomic<size_t>* monitorWord() const
+    {
+        return &head;
+    }
+
+    bool empty() const
+    {
+        return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+    }
+
+    void park(std::chrono::microseconds timeout)
+    {
+        parker.park([this] { return empty(); }, timeout);
+    }
+
+    void wake()
+    {
+        parker.wake();
+    }
+
     size_t getSize()
     {
         size_t h = head.load(std::memory_order_relaxed);
@@ -0,0 +1,147 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <print>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "RingBuffer.h"
+
+// Versioned header at the start of a /dev/shm mapping. Processes only share a ring if
+// they agree on the layout byte for byte.
+struct SharedRingHeader
+{
+    uint64_t magic;
+    uint32_t version;
+    uint32_t multiProducer;
+    uint64_t ringBytes;
+    uint64_t capacity;
+    uint64_t itemBytes;
+    std::atomic<uint32_t> ready;
+};
+
+// A RingBuffer / MpscRingBuffer placed in a named shared-memory object, so the feed
+// handler and the engine can be restarted independently. The engine side creates the
+// ring (or reuses a compatible one left by its previous run); feeds only attach.
+template<typename RingT>
+class SharedRing {
+private:
+    static constexpr uint64_t MAGIC = 0x474e495246504455; // "UDPFRING"
+    static constexpr uint32_t VERSION = 2;
+    static constexpr size_t RING_OFFSET = 4096;
+    static constexpr size_t MAPPING_BYTES = RING_OFFSET + sizeof(RingT);
+
+    static_assert(sizeof(SharedRingHeader) <= RING_OFFSET);
+    static_assert(std::atomic<size_t>::is_always_lock_free, "Ring cursors must be address-free");
+
+    void* base = MAP_FAILED;
+    RingT* ring = nullptr;
+
+    SharedRingHeader* header() const {
+        return static_cast<SharedRingHeader*>(base);
+    }
+
+    bool compatible() const {
+        const SharedRingHeader* h = header();
+        return h->magic == MAGIC
+            && h->version == VERSION
+            && h->multiProducer == RingT::MULTI_PRODUCER
+            && h->ringBytes == sizeof(RingT)
+            && h->capacity == RingT::CAPACITY
+            && h->itemBytes == sizeof(typename RingT::value_type)
+            && h->ready.load(std::memory_order_acquire) == 1;
+    }
+
+    void map(int fd, const std::string& name) {
+        base = mmap(nullptr, MAPPING_BYTES, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+        close(fd);
+
+        if (base == MAP_FAILED) {
+            std::println(stderr, "[SHM] mmap of {} failed", name);
+            exit(EXIT_FAILURE);
+        }
+        ring = reinterpret_cast<RingT*>(static_cast<char*>(base) + RING_OFFSET);
+    }
+
+public:
+    enum class Mode { OpenOrCreate, Attach };
+
+    SharedRing(const std::string& name, Mode mode) {
+        int flags = (mode == Mode::OpenOrCreate) ? (O_RDWR | O_CREAT) : O_RDWR;
+        int fd = shm_open(name.c_str(), flags, 0600);
+
+        if (fd < 0) {
+            std::println(stderr, "[SHM] Cannot open {}", name);
+            exit(EXIT_FAILURE);
+        }
+
+        struct stat st;
+        fstat(fd, &st);
+
+        if (mode == Mode::Attach) {
+            if (static_cast<size_t>(st.st_size) != MAPPING_BYTES) {
+                std::println(stderr, "[SHM] {} has an unexpected size", name);
+                exit(EXIT_FAILURE);
+            }
+
+            map(fd, name);
+
+            if (!compatible()) {
+                std::println(stderr, "[SHM] {} has an incompatible or uninitialized ring", name);
+                exit(EXIT_FAILURE);
+            }
+            return;
+        }
+
+        if (static_cast<size_t>(st.st_size) != MAPPING_BYTES && ftruncate(fd, MAPPING_BYTES) != 0) {
+            std::println(stderr, "[SHM] Cannot size {}", name);
+            exit(EXIT_FAILURE);
+        }
+
+        map(fd, name);
+
+        if (compatible()) {
+            // The previous engine may have died mid-advance. Feeds can still be attached, so
+            // a ring that doesn't add up is refused rather than reset under them.
+            if constexpr (requires { ring->recoverConsumer(); }) {
+                if (!ring->recoverConsumer()) {
+                    std::println(stderr, "[SHM] {} is inconsistent (cursors vs slot sequences): stop its feeds and remove it", name);
+                    exit(EXIT_FAILURE);
+                }
+            }
+            std::println("[SHM] Reusing ring {}", name);
+            return;
+        }
+
+        SharedRingHeader* h = header();
+        h->ready.store(0, std::memory_order_relaxed);
+        new (ring) RingT();
+
+        h->magic = MAGIC;
+        h->version = VERSION;
+        h->multiProducer = RingT::MULTI_PRODUCER;
+        h->ringBytes = sizeof(RingT);
+        h->capacity = RingT::CAPACITY;
+        h->itemBytes = sizeof(typename RingT::value_type);
+        h->ready.store(1, std::memory_order_release);
+
+        std::println("[SHM] Created ring {}", name);
+    }
+
+    ~SharedRing() {
+        if (base != MAP_FAILED) munmap(base, MAPPING_BYTES);
+    }
+
+    SharedRing(const SharedRing&) = delete;
+    SharedRing& operator=(const SharedRing&) = delete;
+    SharedRing(SharedRing&&) = delete;
+    SharedRing& operator=(SharedRing&&) = delete;
+
+    RingT& get() {
+        return *ring;
+    }
+};
@@ -1,7 +1,9 @@
 #pragma once
 #include <iostream>
-#include <thread>
-#include <chrono>
+#include <fstream>
+#include <cstdint>
+#include <ctime>
+#include <cpuid.h>
 #include "Utils.h"
 
 class TSCClock {
@@ -20,33 +22,98 @@ public:
     }
 
     void printCalibration() const {
-        std::cout << "TSC Frequency: " << (1.0 / secondsPerCycle_ / 1e9) << " GHz\n";
+        std::cout << "TSC Frequency: " << (1.0 / secondsPerCycle_ / 1e9) << " GHz (" << source_ << ")\n";
         std::cout << "1 Cycle = " << nanosPerCycle_ << " ns\n";
     }
 
+    // Drift correction: re-derives the rate from the anchor taken at startup.
+    // The longer the session, the more accurate it gets. Call it off the hot path.
+    void refine() {
+        uint64_t cycles = rdtsc() - anchorCycles_;
+        int64_t nanos = monotonicRawNanos() - anchorNanos_;
+
+        if (nanos < MIN_REFINE_NS || cycles == 0) return;
+
+        setNanosPerCycle((double)nanos / (double)cycles);
+        source_ = "refined against CLOCK_MONOTONIC_RAW";
+    }
+
 private:
+    static constexpr int64_t QUICK_CALIBRATION_NS = 10'000'000;
+    static constexpr int64_t MIN_REFINE_NS = 1'000'000'000;
+
     TSCClock() {
-        calibrate();
+        anchorNanos_ = monotonicRawNanos();
+        anchorCycles_ = rdtsc();
+
+        if (uint64_t hz = fromKernel()) {
+            setNanosPerCycle(1e9 / (double)hz);
+            source_ = "kernel tsc_freq_khz";
+        }
+        else if (uint64_t hz = fromCpuid()) {
+            setNanosPerCycle(1e9 / (double)hz);
+            source_ = "CPUID";
+        }
+        else {
+            calibrate();
+        }
+    }
+
+    static int64_t monotonicRawNanos() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+        return (int64_t)ts.tv_sec * 1'000'000'000 + ts.tv_nsec;
+    }
+
+    static uint64_t fromKernel() {
+        std::ifstream f("/sys/devices/system/cpu/cpu0/tsc_freq_khz");
+        uint64_t khz = 0;
+        if (f >> khz) return khz * 1000;
+        return 0;
     }
 
+    static uint64_t fromCpuid() {
+        unsigned int eax, ebx, ecx, edx;
+
+        // Leaf 0x15: TSC = crystal * ebx / eax. Some parts leave the crystal (ecx) at 0.
+        if (__get_cpuid_count(0x15, 0, &eax, &ebx, &ecx, &edx) && eax && ebx) {
+            if (ecx) return (uint64_t)ecx * ebx / eax;
+
+            unsigned int baseMhz, b, c, d;
+            if (__get_cpuid_count(0x16, 0, &baseMhz, &b, &c, &d) && baseMhz) {
+                return (uint64_t)baseMhz * 1'000'000;
+            }
+        }
+
+        return 0;
+    }
+
+    // Last resort: a short busy-wait against CLOCK_MONOTONIC_RAW. refine() makes up for
+    // the precision lost by not waiting longer.
     void calibrate() {
-        std::cout << "Calibrating TSC... (waiting 1 sec)\n";
-        
-        auto start_time = std::chrono::steady_clock::now();
+        int64_t start_ns = monotonicRawNanos();
         uint64_t start_cycles = rdtsc();
 
-        std::this_thread::sleep_for(std::chrono::seconds(1));
+        int64_t end_ns;
+        do {
+            end_ns = monotonicRawNanos();
+        } while (end_ns - start_ns < QUICK_CALIBRATION_NS);
+
+        uint64_t cycle_diff = rdtsc() - start_cycles;
 
-        auto end_time = std::chrono::steady_clock::now();
-        uint64_t end_cycles = rdtsc();
-        
-        auto duration_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count();
-        uint64_t cycle_diff = end_cycles - start_cycles;
+        setNanosPerCycle((double)(end_ns - start_ns) / (double)cycle_diff);
+        source_ = "quick calibration";
+    }
 
-        nanosPerCycle_ = (double)duration_ns / (double)cycle_diff;
+    void setNanosPerCycle(double nanosPerCycle) {
+        nanosPerCycle_ = nanosPerCycle;
         secondsPerCycle_ = nanosPerCycle_ * 1e-9;
     }
 
     double nanosPerCycle_;
     double secondsPerCycle_;
-};
\ No newline at end of file
+
+    int64_t anchorNanos_;
+    uint64_t anchorCycles_;
+    const char* source_ = "";
+};
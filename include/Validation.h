@@ -0,0 +1,71 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <print>
+#include <string_view>
+#include "EngineConfig.h"
+#include "Messages.h"
+
+inline constexpr uint32_t rejectBit(RejectReason reason) {
+    return UINT32_C(1) << static_cast<uint32_t>(reason);
+}
+
+static_assert(static_cast<uint32_t>(RejectReason::COUNT) <= 32, "Reject reasons must fit a 32-bit mask");
+
+// Range checks on a parsed item before it can reach the book arrays. Every check is
+// computed unconditionally and folded into one mask (one bit per RejectReason), so a
+// well-formed item costs a handful of compares and a single predictable branch.
+template<EngineProfileConcept ProfileT>
+inline uint32_t rejectMask(const QueueItem& item) {
+    const bool isAdd = item.type == MsgType::AddOrder;
+    const bool hasQty = isAdd | (item.type == MsgType::ExecutedOrder);
+    const auto side = static_cast<uint8_t>(item.side);
+
+    // Prices are 1..MAX_PRICE-1: 0 and MAX_PRICE are the empty-bid and empty-ask sentinels,
+    // negatives wrap to huge values.
+    const bool badPrice = static_cast<uint32_t>(item.price) - 1 >= static_cast<uint32_t>(ProfileT::MAX_PRICE - 1);
+    const bool badSide = (side != static_cast<uint8_t>(Side::Buy)) & (side != static_cast<uint8_t>(Side::Sell));
+
+    uint32_t mask = 0;
+    mask |= static_cast<uint32_t>(item.instrumentId >= ProfileT::MAX_INSTRUMENTS) * rejectBit(RejectReason::InvalidInstrument);
+    mask |= static_cast<uint32_t>(isAdd & badPrice) * rejectBit(RejectReason::InvalidPrice);
+    mask |= static_cast<uint32_t>(hasQty & (item.quantity == 0)) * rejectBit(RejectReason::InvalidQuantity);
+    mask |= static_cast<uint32_t>(isAdd & badSide) * rejectBit(RejectReason::InvalidSide);
+    return mask;
+}
+
+// Rejected items by reason. An item failing several checks counts under each.
+class RejectCounters {
+private:
+    static constexpr size_t REASONS = static_cast<size_t>(RejectReason::COUNT);
+
+    std::array<uint64_t, REASONS> counts{};
+
+public:
+    inline void add(uint32_t mask) {
+        while (mask) {
+            ++counts[std::countr_zero(mask)];
+            mask &= mask - 1;
+        }
+    }
+
+    inline void add(RejectReason reason) {
+        ++counts[static_cast<size_t>(reason)];
+    }
+
+    uint64_t get(RejectReason reason) const {
+        return counts[static_cast<size_t>(reason)];
+    }
+
+    void report(std::string_view source) const {
+        static constexpr std::string_view NAMES[REASONS] = {
+            "duplicate id", "invalid price", "invalid quantity", "order not found",
+            "system full", "invalid instrument", "invalid side", "malformed"
+        };
+
+        for (size_t i = 0; i < REASONS; ++i) {
+            if (counts[i]) std::println("[{}] Rejected {} items: {}", source, counts[i], NAMES[i]);
+        }
+    }
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <thread>
+#include <cpuid.h>
+#include <immintrin.h>
+#include "Utils.h"
+
+// Idle policies for ring polling loops. idle() is called by a consumer that found the
+// ring empty, pause() by anyone waiting on something without a cache line to watch
+// (the NIC, a full ring), reset() as soon as work shows up again.
+
+template<typename W, typename RingT>
+concept WaitStrategyConcept = requires(W w, RingT& ring) {
+    { w.idle(ring) };
+    { w.pause() };
+    { w.reset() };
+};
+
+// Latency-critical threads: never yields the core. bench/bench_wait measures wake-up
+// latency per strategy (publish to seen, after the consumer went idle). On a single
+// shared vCPU without WAITPKG (so UmwaitWait degrades to a spin) it gave p50/p99:
+//   BusySpinWait  4.8 / 9.2 us     UmwaitWait  4.3 / 7.6 us     FutexWait  9.4 / 81 us
+// There both threads share the core and the scheduler dominates; the futex's p99 is the
+// syscall and wake-up path. Re-run it on the target host with the threads on their own
+// cores before picking anything but BusySpinWait for the engine.
+struct BusySpinWait
+{
+    template<typename RingT>
+    inline void idle(RingT&) noexcept { _mm_pause(); }
+
+    inline void pause() noexcept { _mm_pause(); }
+
+    inline void reset() noexcept {}
+};
+
+inline bool cpu_has_waitpkg()
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) return false;
+    return (ecx & bit_WAITPKG) != 0;
+}
+
+// Spins for SpinCount polls, then arms UMONITOR on the ring's monitorWord() and sleeps in
+// C0.2 with UMWAIT until a publish writes it (or MaxWaitCycles elapse).
+// Falls back to a plain spin on CPUs without WAITPKG.
+template<uint32_t SpinCount = 4096, uint64_t MaxWaitCycles = 100'000>
+class UmwaitWait
+{
+private:
+    static constexpr unsigned int C0_2 = 0;
+
+    uint32_t spins = 0;
+    const bool supported = cpu_has_waitpkg();
+
+    // The emptiness re-check must happen after UMONITOR is armed, otherwise a
+    // publish landing in between would not wake us up.
+    template<typename RingT>
+    __attribute__((target("waitpkg")))
+    static void monitorAndWait(RingT& ring) noexcept {
+        _umonitor(const_cast<void*>(static_cast<const void*>(ring.monitorWord())));
+        if (ring.empty()) {
+            _umwait(C0_2, rdtsc() + MaxWaitCycles);
+        }
+    }
+
+    __attribute__((target("waitpkg")))
+    static void timedPause() noexcept {
+        _tpause(C0_2, rdtsc() + MaxWaitCycles);
+    }
+
+public:
+    template<typename RingT>
+    inline void idle(RingT& ring) noexcept {
+        if (spins < SpinCount || !supported) [[likely]] {
+            ++spins;
+            _mm_pause();
+            return;
+        }
+        monitorAndWait(ring);
+    }
+
+    inline void pause() noexcept {
+        if (spins < SpinCount || !supported) [[likely]] {
+            ++spins;
+            _mm_pause();
+            return;
+        }
+        timedPause();
+    }
+
+    inline void reset() noexcept { spins = 0; }
+};
+
+// Non-critical consumers sharing a core: spins briefly, then parks on a futex until the
+// producer wakes it. A missed wake-up costs at most MaxSleep.
+template<uint32_t SpinCount = 1024, int64_t MaxSleepUs = 1000>
+class FutexWait
+{
+private:
+    uint32_t spins = 0;
+
+public:
+    template<typename RingT>
+    inline void idle(RingT& ring) noexcept {
+        if (spins < SpinCount) [[likely]] {
+            ++spins;
+            _mm_pause();
+            return;
+        }
+        ring.park(std::chrono::microseconds(MaxSleepUs));
+    }
+
+    inline void pause() noexcept {
+        if (spins < SpinCount) [[likely]] {
+            ++spins;
+            _mm_pause();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(MaxSleepUs));
+    }
+
+    inline void reset() noexcept { spins = 0; }
+};
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Messages.h"
+
+// On-disk layout of a market-data capture:
+//
+//   FileHeader, then BlockHeader + payload repeated until EOF.
+//
+// A block holds up to BLOCK_EVENTS consecutive events of one instrument from one feed,
+// stored column by column. Each column is a byte stream whose length is in the header:
+//
+//   seq      zig-zag varint delta from the previous event (the first from firstSeq)
+//   arrival  varint delta from the previous event (the first from firstArrival)
+//   flags    4 bits per event, two per byte: type code (bits 0-1), Sell (bit 2)
+//   id       zig-zag varint delta from the previous event's id
+//   price    zig-zag varint delta from the previous add's price, adds only
+//   qty      varint, adds and executions only
+//
+// Fields a message type doesn't carry are not stored and decode as 0. `arrival` numbers
+// every captured event in tap order, across instruments and feeds. Blocks are written
+// when they fill up, so a later block can hold earlier arrivals: every block after this
+// one only holds arrivals from `watermark` on.
+namespace Capture {
+
+    inline constexpr uint64_t MAGIC = 0x3150414346504455; // "UDPFCAP1"
+    inline constexpr uint32_t VERSION = 2;
+    inline constexpr uint32_t BLOCK_EVENTS = 4096;
+
+    enum Column : uint32_t { Seq, Arrival, Flags, Id, Price, Qty, COLUMNS };
+
+    struct FileHeader
+    {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t blockEvents;
+    };
+
+    struct BlockHeader
+    {
+        uint64_t firstSeq;
+        uint64_t firstArrival;
+        uint64_t watermark;
+        uint32_t count;
+        uint16_t instrumentId;
+        uint8_t feedId;
+        uint8_t reserved;
+        uint32_t columnBytes[COLUMNS];
+    };
+
+    inline uint64_t zigzag(int64_t v) {
+        return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+    }
+
+    inline int64_t unzigzag(uint64_t v) {
+        return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+    }
+
+    inline void putVarint(std::vector<uint8_t>& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<uint8_t>(v) | 0x80);
+            v >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(v));
+    }
+
+    // Advances `p`; false on a varint running past `end` or longer than 10 bytes.
+    inline bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+        v = 0;
+        for (unsigned shift = 0; shift < 64 && p < end; shift += 7) {
+            uint8_t byte = *p++;
+            v |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+
+    inline uint8_t typeCode(MsgType type) {
+        switch (type) {
+            case MsgType::AddOrder: return 0;
+            case MsgType::CancelOrder: return 1;
+            case MsgType::ExecutedOrder: return 2;
+            case MsgType::OwnOrder: return 3;
+        }
+        return 1;
+    }
+
+    inline constexpr MsgType TYPES[4] = {MsgType::AddOrder, MsgType::CancelOrder, MsgType::ExecutedOrder, MsgType::OwnOrder};
+
+} // namespace Capture
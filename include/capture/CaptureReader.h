@@ -0,0 +1,295 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <print>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CaptureFormat.h"
+#include "EngineConfig.h"
+#include "Validation.h"
+
+namespace Capture {
+
+    struct EncodedBlock
+    {
+        BlockHeader header;
+        std::vector<uint8_t> payload;
+    };
+
+    // False on a corrupt block (columns shorter than the header says).
+    inline bool decodeBlock(const EncodedBlock& block, std::vector<QueueItem>& out, std::vector<uint64_t>& arrivals) {
+        const BlockHeader& h = block.header;
+        out.assign(h.count, QueueItem{});
+        arrivals.resize(h.count);
+
+        const uint8_t* col[COLUMNS];
+        const uint8_t* end[COLUMNS];
+        const uint8_t* p = block.payload.data();
+        for (uint32_t c = 0; c < COLUMNS; ++c) {
+            col[c] = p;
+            p += h.columnBytes[c];
+            end[c] = p;
+        }
+
+        if (h.columnBytes[Flags] < (h.count + 1) / 2) return false;
+
+        uint64_t seq = h.firstSeq;
+        uint64_t arrival = h.firstArrival;
+        uint64_t id = 0;
+        int32_t price = 0;
+        uint64_t v;
+
+        for (uint32_t i = 0; i < h.count; ++i) {
+            QueueItem& item = out[i];
+            uint8_t flags = (col[Flags][i / 2] >> ((i & 1) * 4)) & 0xf;
+
+            if (!getVarint(col[Seq], end[Seq], v)) return false;
+            seq += static_cast<uint64_t>(unzigzag(v));
+
+            if (!getVarint(col[Arrival], end[Arrival], v)) return false;
+            arrival += v;
+            arrivals[i] = arrival;
+
+            if (!getVarint(col[Id], end[Id], v)) return false;
+            id += static_cast<uint64_t>(unzigzag(v));
+
+            item.seqNum = seq;
+            item.id = id;
+            item.instrumentId = h.instrumentId;
+            item.feedId = h.feedId;
+            item.type = TYPES[flags & 3];
+
+            if (item.type == MsgType::AddOrder) {
+                if (!getVarint(col[Price], end[Price], v)) return false;
+                price += static_cast<int32_t>(unzigzag(v));
+                item.price = price;
+                item.side = (flags & 4) ? Side::Sell : Side::Buy;
+            }
+            if (item.type == MsgType::AddOrder || item.type == MsgType::ExecutedOrder) {
+                if (!getVarint(col[Qty], end[Qty], v)) return false;
+                item.quantity = static_cast<uint32_t>(v);
+            }
+        }
+        return true;
+    }
+
+} // namespace Capture
+
+class CaptureReader {
+private:
+    // Five varints (seq, arrival, id, price, qty) at most 10 bytes each, plus the flags nibble.
+    static constexpr size_t MAX_EVENT_BYTES = 51;
+
+    std::ifstream file;
+    uint32_t blockEvents = 0;
+    bool failed = false;
+
+public:
+    explicit CaptureReader(const std::string& path) : file(path, std::ios::binary) {
+        Capture::FileHeader header{};
+
+        if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            std::println(stderr, "[CAPTURE] Cannot read {}", path);
+            exit(EXIT_FAILURE);
+        }
+        if (header.magic != Capture::MAGIC || header.version != Capture::VERSION) {
+            std::println(stderr, "[CAPTURE] {} is not a version {} capture", path, Capture::VERSION);
+            exit(EXIT_FAILURE);
+        }
+        blockEvents = header.blockEvents;
+    }
+
+    // Reads up to `out.size()` blocks into `out`, reusing their buffers. Returns how many were read.
+    size_t read(std::span<Capture::EncodedBlock> out) {
+        size_t n = 0;
+
+        while (n < out.size() && !failed) {
+            Capture::EncodedBlock& block = out[n];
+            if (!file.read(reinterpret_cast<char*>(&block.header), sizeof(Capture::BlockHeader))) break;
+
+            size_t payloadBytes = 0;
+            for (uint32_t bytes : block.header.columnBytes) payloadBytes += bytes;
+
+            if (block.header.count == 0 || block.header.count > blockEvents || payloadBytes > block.header.count * MAX_EVENT_BYTES) {
+                std::println(stderr, "[CAPTURE] Corrupt block header, stopping");
+                failed = true;
+                break;
+            }
+
+            block.payload.resize(payloadBytes);
+            if (!file.read(reinterpret_cast<char*>(block.payload.data()), static_cast<std::streamsize>(payloadBytes))) {
+                std::println(stderr, "[CAPTURE] Truncated block, stopping");
+                failed = true;
+                break;
+            }
+            ++n;
+        }
+        return n;
+    }
+};
+
+struct ReplayStats
+{
+    uint64_t events = 0;
+    uint64_t blocks = 0;
+    uint64_t corruptBlocks = 0;
+    uint64_t rejectedEvents = 0;
+    double seconds = 0;
+};
+
+// Book reconstruction. Waves of blocks are read and decoded in parallel while the
+// calling thread applies the previous wave. Blocks come in write order, not arrival
+// order: decoded events are held until the header watermark says no later block can
+// precede them, then applied in arrival order across instruments and feeds, as the live
+// engine saw them. Decoded items go through the same range checks as the live parser,
+// on the decode threads.
+template<EngineProfileConcept ProfileT, typename MarketT>
+ReplayStats replayCapture(const std::string& path, MarketT& market, unsigned threads) {
+    static constexpr size_t BLOCKS_PER_THREAD = 16;
+
+    struct Wave {
+        std::vector<Capture::EncodedBlock> encoded;
+        std::vector<std::vector<QueueItem>> decoded;
+        std::vector<std::vector<uint64_t>> arrivals;
+        std::vector<uint8_t> ok;
+        std::vector<size_t> rejected;
+        size_t size = 0;
+    };
+
+    // Decoded events not applied yet, with their arrival numbers.
+    struct Held {
+        std::vector<QueueItem> items;
+        std::vector<uint64_t> arrivals;
+    };
+
+    threads = std::max(threads, 1u);
+    const size_t waveSize = threads * BLOCKS_PER_THREAD;
+
+    CaptureReader reader(path);
+    Wave waves[2];
+    for (Wave& w : waves) {
+        w.encoded.resize(waveSize);
+        w.decoded.resize(waveSize);
+        w.arrivals.resize(waveSize);
+        w.ok.resize(waveSize);
+        w.rejected.resize(waveSize);
+    }
+
+    auto load = [&](Wave& w) {
+        w.size = reader.read(w.encoded);
+
+        std::vector<std::jthread> workers;
+        workers.reserve(threads);
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back([&w, t, threads] {
+                for (size_t i = t; i < w.size; i += threads) {
+                    std::vector<QueueItem>& items = w.decoded[i];
+                    std::vector<uint64_t>& arrivals = w.arrivals[i];
+                    w.ok[i] = Capture::decodeBlock(w.encoded[i], items, arrivals);
+
+                    size_t kept = 0;
+                    for (size_t k = 0; k < items.size(); ++k) {
+                        if (rejectMask<ProfileT>(items[k]) != 0) continue;
+                        items[kept] = items[k];
+                        arrivals[kept++] = arrivals[k];
+                    }
+                    w.rejected[i] = items.size() - kept;
+                    items.resize(kept);
+                    arrivals.resize(kept);
+                }
+            });
+        }
+    };
+
+    ReplayStats stats;
+    Held held, later;
+    std::vector<QueueItem> ordered;
+    std::vector<uint8_t> present;
+
+    // Applies the held events numbered below `limit`, in arrival order.
+    auto applyBefore = [&](uint64_t limit) {
+        later.items.clear();
+        later.arrivals.clear();
+        ordered.clear();
+
+        uint64_t lo = UINT64_MAX, hi = 0;
+        for (size_t i = 0; i < held.items.size(); ++i) {
+            uint64_t a = held.arrivals[i];
+            if (a >= limit) {
+                later.items.push_back(held.items[i]);
+                later.arrivals.push_back(a);
+                continue;
+            }
+            lo = std::min(lo, a);
+            hi = std::max(hi, a);
+            ordered.push_back(held.items[i]);
+        }
+
+        size_t n = ordered.size();
+        if (n != 0 && hi - lo < 2 * n) {
+            // Numbers are dense but for rejected events and corrupt blocks: place each by its own.
+            ordered.assign(hi - lo + 1, QueueItem{});
+            present.assign(hi - lo + 1, 0);
+            for (size_t i = 0; i < held.items.size(); ++i) {
+                uint64_t a = held.arrivals[i];
+                if (a >= limit) continue;
+                ordered[a - lo] = held.items[i];
+                present[a - lo] = 1;
+            }
+
+            size_t out = 0;
+            for (size_t k = 0; k < ordered.size(); ++k) {
+                if (present[k]) ordered[out++] = ordered[k];
+            }
+            ordered.resize(out);
+        }
+        else if (n != 0) {
+            // Too sparse to place (damaged numbering): sort instead.
+            std::vector<std::pair<uint64_t, size_t>> order;
+            for (size_t i = 0; i < held.items.size(); ++i) {
+                if (held.arrivals[i] < limit) order.emplace_back(held.arrivals[i], i);
+            }
+            std::sort(order.begin(), order.end());
+            for (size_t k = 0; k < order.size(); ++k) ordered[k] = held.items[order[k].second];
+        }
+
+        for (size_t i = 0; i < ordered.size(); i += Capture::BLOCK_EVENTS) {
+            market.onBatch(std::span<const QueueItem>(ordered).subspan(i, std::min<size_t>(Capture::BLOCK_EVENTS, ordered.size() - i)));
+        }
+        stats.events += ordered.size();
+
+        std::swap(held, later);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+
+    load(waves[0]);
+
+    for (size_t cur = 0; waves[cur].size != 0; cur ^= 1) {
+        std::jthread next([&] { load(waves[cur ^ 1]); });
+
+        const Wave& w = waves[cur];
+        for (size_t i = 0; i < w.size; ++i) {
+            if (!w.ok[i]) {
+                ++stats.corruptBlocks;
+                continue;
+            }
+            held.items.insert(held.items.end(), w.decoded[i].begin(), w.decoded[i].end());
+            held.arrivals.insert(held.arrivals.end(), w.arrivals[i].begin(), w.arrivals[i].end());
+            stats.rejectedEvents += w.rejected[i];
+        }
+        stats.blocks += w.size;
+
+        applyBefore(w.encoded[w.size - 1].header.watermark);
+    }
+
+    applyBefore(UINT64_MAX);
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
@@ -0,0 +1,194 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <print>
+#include <span>
+#include <string>
+#include <vector>
+#include "CaptureFormat.h"
+#include "EngineConfig.h"
+#include "Globals.h"
+#include "Utils.h"
+#include "WaitStrategy.h"
+
+// Records every normalized event from a tap of the engine's input. Events are numbered
+// in arrival order, buffered per instrument and encoded one full block at a time, on the
+// capture core. Partial blocks are written out every FLUSH_INTERVAL, so a killed process
+// loses at most that much of the session.
+template<EngineProfileConcept ProfileT>
+class CaptureWriter {
+private:
+    static constexpr size_t MAX_INSTRUMENTS = ProfileT::MAX_INSTRUMENTS;
+    static constexpr size_t MAX_BATCH = 256;
+    static constexpr auto FLUSH_INTERVAL = std::chrono::seconds(1);
+
+    std::ofstream file;
+    std::vector<std::vector<QueueItem>> pending;
+    std::vector<std::vector<uint64_t>> pendingArrivals;
+    uint64_t nextArrival = 0;
+    std::array<std::vector<uint8_t>, Capture::COLUMNS> columns;
+
+    uint64_t events = 0;
+    uint64_t bytes = 0;
+
+    void writeRaw(const void* data, size_t len) {
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(len));
+        bytes += len;
+    }
+
+    void encode(std::span<const QueueItem> items, std::span<const uint64_t> arrivals) {
+        for (auto& c : columns) c.clear();
+
+        uint64_t prevSeq = items.front().seqNum;
+        uint64_t prevArrival = arrivals.front();
+        uint64_t prevId = 0;
+        int32_t prevPrice = 0;
+        uint8_t packed = 0;
+
+        for (size_t i = 0; i < items.size(); ++i) {
+            const QueueItem& item = items[i];
+
+            Capture::putVarint(columns[Capture::Seq], Capture::zigzag(static_cast<int64_t>(item.seqNum - prevSeq)));
+            Capture::putVarint(columns[Capture::Id], Capture::zigzag(static_cast<int64_t>(item.id - prevId)));
+            Capture::putVarint(columns[Capture::Arrival], arrivals[i] - prevArrival);
+            prevSeq = item.seqNum;
+            prevArrival = arrivals[i];
+            prevId = item.id;
+
+            uint8_t flags = Capture::typeCode(item.type);
+
+            if (item.type == MsgType::AddOrder) {
+                flags |= (item.side == Side::Sell) << 2;
+                Capture::putVarint(columns[Capture::Price], Capture::zigzag(static_cast<int64_t>(item.price) - prevPrice));
+                prevPrice = item.price;
+            }
+            if (item.type == MsgType::AddOrder || item.type == MsgType::ExecutedOrder) {
+                Capture::putVarint(columns[Capture::Qty], item.quantity);
+            }
+
+            packed |= flags << ((i & 1) * 4);
+            if (i & 1) {
+                columns[Capture::Flags].push_back(packed);
+                packed = 0;
+            }
+        }
+
+        if (items.size() & 1) columns[Capture::Flags].push_back(packed);
+    }
+
+    // Oldest arrival left to write once instrument `flushed` is out.
+    uint64_t watermark(uint16_t flushed) const {
+        uint64_t oldest = nextArrival;
+        for (size_t i = 0; i < MAX_INSTRUMENTS; ++i) {
+            if (i != flushed && !pendingArrivals[i].empty()) oldest = std::min(oldest, pendingArrivals[i].front());
+        }
+        return oldest;
+    }
+
+    void flush(uint16_t instrId) {
+        std::vector<QueueItem>& items = pending[instrId];
+        std::vector<uint64_t>& arrivals = pendingArrivals[instrId];
+        if (items.empty()) return;
+
+        encode(items, arrivals);
+
+        Capture::BlockHeader header{};
+        header.firstSeq = items.front().seqNum;
+        header.firstArrival = arrivals.front();
+        header.count = static_cast<uint32_t>(items.size());
+        header.instrumentId = instrId;
+        header.watermark = watermark(instrId);
+        header.feedId = items.front().feedId;
+        for (uint32_t c = 0; c < Capture::COLUMNS; ++c) {
+            header.columnBytes[c] = static_cast<uint32_t>(columns[c].size());
+        }
+
+        writeRaw(&header, sizeof(header));
+        for (const auto& c : columns) writeRaw(c.data(), c.size());
+
+        events += items.size();
+        items.clear();
+        arrivals.clear();
+    }
+
+public:
+    explicit CaptureWriter(const std::string& path)
+        : file(path, std::ios::binary | std::ios::trunc), pending(MAX_INSTRUMENTS), pendingArrivals(MAX_INSTRUMENTS) {
+        if (!file.is_open()) {
+            std::println(stderr, "[CAPTURE] Cannot open {}", path);
+            exit(EXIT_FAILURE);
+        }
+
+        for (auto& items : pending) items.reserve(Capture::BLOCK_EVENTS);
+        for (auto& arrivals : pendingArrivals) arrivals.reserve(Capture::BLOCK_EVENTS);
+
+        Capture::FileHeader header{Capture::MAGIC, Capture::VERSION, Capture::BLOCK_EVENTS};
+        writeRaw(&header, sizeof(header));
+    }
+
+    inline void record(const QueueItem& item) {
+        if (item.instrumentId >= MAX_INSTRUMENTS) [[unlikely]] return;
+
+        std::vector<QueueItem>& items = pending[item.instrumentId];
+
+        // A block carries one feed id.
+        if (!items.empty() && items.front().feedId != item.feedId) [[unlikely]] {
+            flush(item.instrumentId);
+        }
+
+        items.push_back(item);
+        pendingArrivals[item.instrumentId].push_back(nextArrival++);
+
+        if (items.size() == Capture::BLOCK_EVENTS) {
+            flush(item.instrumentId);
+        }
+    }
+
+    void flushAll() {
+        for (size_t i = 0; i < MAX_INSTRUMENTS; ++i) {
+            flush(static_cast<uint16_t>(i));
+        }
+        file.flush();
+    }
+
+    template<typename RingT, typename WaitT = FutexWait<>>
+    void run(RingT& tap, const std::atomic<uint64_t>& tapDrops, int coreId) {
+        pin_to_core(coreId);
+        std::println("Capture started...");
+
+        WaitT wait;
+        auto nextFlush = std::chrono::steady_clock::now() + FLUSH_INTERVAL;
+
+        while (running) {
+            std::span<QueueItem> batch = tap.peekBatch(MAX_BATCH);
+            if (batch.empty()) {
+                wait.idle(tap);
+            }
+            else {
+                wait.reset();
+
+                for (const QueueItem& item : batch) record(item);
+                tap.advance(batch.size());
+            }
+
+            auto now = std::chrono::steady_clock::now();
+            if (now >= nextFlush) {
+                flushAll();
+                nextFlush = now + FLUSH_INTERVAL;
+            }
+        }
+
+        flushAll();
+
+        std::println("[CAPTURE] {} events, {} bytes ({} bytes/event)", events, bytes,
+                     events ? static_cast<double>(bytes) / static_cast<double>(events) : 0.0);
+        if (uint64_t drops = tapDrops.load(std::memory_order_relaxed)) {
+            std::println(stderr, "[CAPTURE] Tap overflowed: {} events missing from the capture", drops);
+        }
+    }
+};
@@ -3,14 +3,17 @@
 #include <bit>
 #include <array>
 #include <cstddef>
+#include <span>
+#include "Messages.h"
 
+template<int32_t MAX_PRICE>
 class BboBitset {
 private:
-    static constexpr int32_t MAX_PRICE{100000};
-
     static constexpr size_t L0_SIZE = (MAX_PRICE / 64) + 1;
     static constexpr size_t L1_SIZE = (L0_SIZE / 64) + 1;
 
+    static_assert(MAX_PRICE > 0 && L1_SIZE <= 64, "Price range must fit a 3-level bitset (< 262144)");
+
     uint64_t root{0ULL};
 
     std::array<uint64_t, L1_SIZE> l1{};
@@ -24,7 +27,23 @@ private:
         return static_cast<int32_t>(std::countr_zero(mask));
     }
 
+    // Masks keeping bits >= b / <= b of a word.
+    static constexpr uint64_t fromBit(uint32_t b) noexcept { return ~UINT64_C(0) << b; }
+    static constexpr uint64_t uptoBit(uint32_t b) noexcept { return ~UINT64_C(0) >> (63 - b); }
+
+    constexpr int32_t lowestUnder(int32_t i1) const noexcept {
+        auto i0 = i1 * 64 + lowestBit(l1[i1]);
+        return i0 * 64 + lowestBit(l0[i0]);
+    }
+
+    constexpr int32_t highestUnder(int32_t i1) const noexcept {
+        auto i0 = i1 * 64 + highestBit(l1[i1]);
+        return i0 * 64 + highestBit(l0[i0]);
+    }
+
 public:
+    static constexpr int32_t NONE = -1;
+
     constexpr void setPrice(int32_t price) noexcept {
         auto u_price = static_cast<uint32_t>(price);
 
@@ -75,18 +94,81 @@ public:
     constexpr int32_t getBestBid() const noexcept {
         if(!root) [[unlikely]] return 0;
 
-        auto i1 = highestBit(root);
-        auto i0 = i1 * 64 + highestBit(l1[i1]);
-
-        return i0 * 64 + highestBit(l0[i0]);
+        return highestUnder(highestBit(root));
     }
 
     constexpr int32_t getBestAsk() const noexcept {
         if(!root) [[unlikely]] return MAX_PRICE;
 
-        auto i1 = lowestBit(root);
-        auto i0 = i1 * 64 + lowestBit(l1[i1]);
+        return lowestUnder(lowestBit(root));
+    }
 
-        return i0 * 64 + lowestBit(l0[i0]);
+    // Lowest populated price strictly above `price`, or NONE. At most one word test per level.
+    constexpr int32_t nextHigher(int32_t price) const noexcept {
+        auto q = static_cast<uint32_t>(price + 1);
+        if (q > static_cast<uint32_t>(MAX_PRICE)) return NONE;
+
+        auto i0 = q / 64;
+        if (uint64_t m0 = l0[i0] & fromBit(q & 63)) {
+            return static_cast<int32_t>(i0 * 64) + lowestBit(m0);
+        }
+
+        auto q1 = i0 + 1;
+        if (q1 >= L0_SIZE) return NONE;
+
+        auto i1 = q1 / 64;
+        if (uint64_t m1 = l1[i1] & fromBit(q1 & 63)) {
+            auto j0 = static_cast<int32_t>(i1 * 64) + lowestBit(m1);
+            return j0 * 64 + lowestBit(l0[j0]);
+        }
+
+        auto q2 = i1 + 1;
+        if (q2 >= 64) return NONE;
+
+        uint64_t mr = root & fromBit(q2);
+        return mr ? lowestUnder(lowestBit(mr)) : NONE;
+    }
+
+    // Highest populated price strictly below `price`, or NONE. Anything above the grid
+    // reads as MAX_PRICE + 1: below it is every price.
+    constexpr int32_t nextLower(int32_t price) const noexcept {
+        if (price <= 0) return NONE;
+        if (price > MAX_PRICE + 1) price = MAX_PRICE + 1;
+        auto q = static_cast<uint32_t>(price - 1);
+
+        auto i0 = q / 64;
+        if (uint64_t m0 = l0[i0] & uptoBit(q & 63)) {
+            return static_cast<int32_t>(i0 * 64) + highestBit(m0);
+        }
+
+        if (i0 == 0) return NONE;
+        auto q1 = i0 - 1;
+
+        auto i1 = q1 / 64;
+        if (uint64_t m1 = l1[i1] & uptoBit(q1 & 63)) {
+            auto j0 = static_cast<int32_t>(i1 * 64) + highestBit(m1);
+            return j0 * 64 + highestBit(l0[j0]);
+        }
+
+        if (i1 == 0) return NONE;
+
+        uint64_t mr = root & uptoBit(i1 - 1);
+        return mr ? highestUnder(highestBit(mr)) : NONE;
+    }
+
+    // Best `out.size()` populated prices on side S, best first. Returns how many were found.
+    template<Side S>
+    constexpr size_t top(std::span<int32_t> out) const noexcept {
+        if (!root || out.empty()) return 0;
+
+        int32_t price = (S == Side::Buy) ? getBestBid() : getBestAsk();
+        size_t n = 0;
+
+        while (price != NONE && n < out.size()) {
+            out[n++] = price;
+            price = (S == Side::Buy) ? nextLower(price) : nextHigher(price);
+        }
+
+        return n;
     }
 };
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct BookAnalytics
+{
+    int32_t bestBid;
+    int32_t bestAsk;
+    uint32_t bidVolume;
+    uint32_t askVolume;
+    uint32_t bidOrders;
+    uint32_t askOrders;
+
+    // (bidVolume - askVolume) / (bidVolume + askVolume), in [-1, 1]. 0 on an empty touch.
+    double imbalance;
+
+    // Size-weighted mid: leans towards the side with less resting volume. 0 if a side is empty.
+    double microprice;
+
+    // VWAP over the last RollingVwap::WINDOW executions. 0 before the first one.
+    double vwap;
+};
+
+struct DepthLevel
+{
+    int32_t price;
+    uint32_t volume;
+    uint32_t orders;
+};
+
+// Trade VWAP over a fixed window of executions, kept as running sums: O(1) per trade.
+template<size_t Window>
+class RollingVwap
+{
+    static_assert((Window & (Window - 1)) == 0, "Window must be a power of 2");
+
+private:
+    struct Fill {
+        int64_t notional = 0;
+        uint32_t qty = 0;
+    };
+
+    std::array<Fill, Window> fills{};
+    size_t next = 0;
+
+    int64_t notionalSum = 0;
+    uint64_t qtySum = 0;
+
+public:
+    static constexpr size_t WINDOW = Window;
+
+    inline void onExecution(int32_t price, uint32_t qty) {
+        Fill& slot = fills[next++ & (Window - 1)];
+
+        notionalSum -= slot.notional;
+        qtySum -= slot.qty;
+
+        slot.notional = static_cast<int64_t>(price) * qty;
+        slot.qty = qty;
+
+        notionalSum += slot.notional;
+        qtySum += slot.qty;
+    }
+
+    inline double value() const {
+        return qtySum ? static_cast<double>(notionalSum) / static_cast<double>(qtySum) : 0.0;
+    }
+};
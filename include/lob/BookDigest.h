@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include "RingBuffer.h"
+
+// One level's share of a side's book hash. The hash is the sum over the side's non-empty
+// levels, so the engine updates it in O(1) when a level changes and a reference book can
+// recompute it from scratch.
+inline uint64_t levelHash(int32_t price, uint64_t volume, uint32_t orders)
+{
+    if ((volume | orders) == 0) return 0;
+
+    uint64_t x = ((static_cast<uint64_t>(static_cast<uint32_t>(price)) << 32) | orders) * UINT64_C(0x9E3779B97F4A7C15);
+    x ^= volume * UINT64_C(0xC2B2AE3D27D4EB4F);
+    x ^= x >> 29;
+    x *= UINT64_C(0xBF58476D1CE4E5B9);
+    x ^= x >> 32;
+    return x;
+}
+
+// Book summary the engine exports for out-of-band checks: the touch, plus a hash of every
+// level's (price, volume, orders) per side.
+struct BookDigest
+{
+    uint64_t seqNum; // last message applied to this instrument
+    int32_t bestBid;
+    int32_t bestAsk;
+    uint32_t bidVolume;
+    uint32_t askVolume;
+    uint32_t bidOrders;
+    uint32_t askOrders;
+    uint64_t bidHash;
+    uint64_t askHash;
+};
+
+// One seqlock per instrument: the engine never waits, readers retry on a torn copy.
+template<size_t MAX_INSTRUMENTS>
+class DigestTable {
+private:
+    struct alignas(hardware_destructive_interference_size) Slot {
+        std::atomic<uint32_t> version{0};
+        BookDigest digest{};
+    };
+
+    std::array<Slot, MAX_INSTRUMENTS> slots;
+
+public:
+    void write(uint16_t instrId, const BookDigest& digest) {
+        Slot& slot = slots[instrId];
+        uint32_t v = slot.version.load(std::memory_order_relaxed);
+
+        slot.version.store(v + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.digest = digest;
+
+        slot.version.store(v + 2, std::memory_order_release);
+    }
+
+    // False if the slot was being written; the caller just tries again later.
+    bool read(uint16_t instrId, BookDigest& out) const {
+        const Slot& slot = slots[instrId];
+
+        uint32_t before = slot.version.load(std::memory_order_acquire);
+        if (before & 1) return false;
+
+        out = slot.digest;
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.version.load(std::memory_order_relaxed) == before && before != 0;
+    }
+};
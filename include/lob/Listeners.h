@@ -38,6 +38,17 @@ struct ConsoleListener
         std::println("[INSTR {}] [MKT DATA] Price Level {} ({}) is now {}", 
                      instrId, price, (side == Side::Buy ? "Bid" : "Ask"), volume);
     }
+
+    void onBboUpdate(uint16_t instrId, int32_t bid, int32_t ask)
+    {
+        std::println("[INSTR {}] [BBO] {} / {}", instrId, bid, ask);
+    }
+
+    void onTradePrint(const TradePrint& t)
+    {
+        std::println("[INSTR {}] [TAPE] {} {} @ {}..{} ({} fills, seq {})", 
+                     t.instrumentId, (t.aggressorSide == Side::Buy ? "Buy" : "Sell"), t.quantity, t.price, t.lastPrice, t.fills, t.seqNum);
+    }
 };
 
 struct EmptyListener
@@ -53,6 +64,8 @@ struct EmptyListener
     void onTrade(uint16_t, uint64_t, uint64_t, int32_t, uint32_t) {}
 
     void onOrderBookUpdate(uint16_t, int32_t, uint32_t, Side) {}
+
+    void onBboUpdate(uint16_t, int32_t, int32_t) {}
 };
 
 struct VectorListener {
@@ -101,6 +114,7 @@ struct VectorListener {
     
     void onOrderAdded(uint16_t, uint64_t, int32_t, uint32_t, Side) {}
     void onOrderBookUpdate(uint16_t, int32_t, uint32_t, Side) {}
+    void onBboUpdate(uint16_t, int32_t, int32_t) {}
 
     void clear() 
     {
@@ -108,4 +122,27 @@ struct VectorListener {
         cancelledOrders.clear();
         rejectedOrders.clear();
     }
-};
\ No newline at end of file
+};
+
+// Publishes aggregated trade prints to a ring for tape consumers on other cores.
+template<typename RingT>
+struct TradeTapeListener
+{
+    RingT& tape;
+    uint64_t dropped = 0;
+
+    explicit TradeTapeListener(RingT& ring) : tape(ring) {}
+
+    void onTradePrint(const TradePrint& print)
+    {
+        if (!tape.push(print)) [[unlikely]] ++dropped;
+    }
+
+    void onOrderAdded(uint16_t, uint64_t, int32_t, uint32_t, Side) {}
+    void onOrderCancelled(uint16_t, uint64_t) {}
+    void onOrderExecuted(uint16_t, uint64_t, uint32_t) {}
+    void onOrderRejected(uint16_t, uint64_t, RejectReason) {}
+    void onTrade(uint16_t, uint64_t, uint64_t, int32_t, uint32_t) {}
+    void onOrderBookUpdate(uint16_t, int32_t, uint32_t, Side) {}
+    void onBboUpdate(uint16_t, int32_t, int32_t) {}
+};
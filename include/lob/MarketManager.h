@@ -1,8 +1,16 @@
 #pragma once
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <optional>
+#include <span>
 #include <vector>
+#include "EngineConfig.h"
+#include "Messages.h"
+#include "BookDigest.h"
 #include "PassiveOrderBook.h"
 #include "OrderPool.h"
+#include "OwnOrderTracker.h"
 
 template<typename T>
 concept TradeListenerConcept = requires(T t, uint16_t inst, uint64_t id, int32_t p, uint32_t q, Side s, RejectReason r) {
@@ -12,83 +20,436 @@ concept TradeListenerConcept = requires(T t, uint16_t inst, uint64_t id, int32_t
     { t.onOrderExecuted(inst, id, q) };
     { t.onOrderRejected(inst, id, r) };
     { t.onOrderBookUpdate(inst, p, q, s) };
+    { t.onBboUpdate(inst, p, p) };
 };
 
-template<TradeListenerConcept ListenerT>
+template<TradeListenerConcept ListenerT, EngineProfileConcept ProfileT = DefaultProfile>
 class MarketManager {
 private:
-    static constexpr size_t MAX_INSTRUMENTS = 64;
-    static constexpr size_t MAX_LIVE_ORDERS = 1'000'000; 
-    static constexpr size_t MAX_ORDER_IDS = 10'000'000;
+    static constexpr size_t MAX_INSTRUMENTS = ProfileT::MAX_INSTRUMENTS;
+    static constexpr size_t MAX_LIVE_ORDERS = ProfileT::MAX_LIVE_ORDERS;
+    static constexpr size_t MAX_ORDER_IDS = ProfileT::MAX_ORDER_IDS;
+    static constexpr size_t DIRTY_WORDS = (MAX_INSTRUMENTS + 63) / 64;
+
+    struct Bbo {
+        int32_t bid = 0;
+        int32_t ask = ProfileT::MAX_PRICE;
+    };
 
     OrderPool pool;
     std::vector<int32_t> orderIndexLookup;
 
-    std::array<PassiveOrderBook, MAX_INSTRUMENTS> books;
+    std::array<PassiveOrderBook<ProfileT::MAX_PRICE>, MAX_INSTRUMENTS> books;
+
+    // Batch mode: instruments touched by the current batch and the last BBO reported for each.
+    std::array<uint64_t, DIRTY_WORDS> dirty{};
+    std::array<Bbo, MAX_INSTRUMENTS> lastBbo{};
+
+    // Batch mode: levels touched by the current batch, reported once each with their final
+    // volume at the end of it. A batch touching more levels flushes early.
+    static constexpr size_t MAX_TOUCHED_LEVELS = 64;
+    std::array<uint64_t, MAX_TOUCHED_LEVELS> touchedLevels;
+    size_t touchedCount = 0;
+
+    // Batch mode: optional seqlock export for an off-core verifier.
+    DigestTable<MAX_INSTRUMENTS>* digests = nullptr;
+    std::array<uint64_t, MAX_INSTRUMENTS> lastSeq{};
+
+    // Batch mode: trade print being built from consecutive fills.
+    TradePrint pendingTrade{};
+    bool hasPendingTrade = false;
+
+    OwnOrderTracker ownOrders;
 
     ListenerT& listener;
 
-public:
-    MarketManager(ListenerT& l): listener(l), pool(MAX_LIVE_ORDERS), orderIndexLookup(MAX_ORDER_IDS, -1) {};
-    
-    inline void onAddOrder(uint16_t instrId, uint64_t id, int32_t price, uint32_t quantity, Side side) {
+    inline void markDirty(uint16_t instrId) {
+        dirty[instrId / 64] |= UINT64_C(1) << (instrId & 63);
+    }
+
+    static uint64_t touchedKey(uint16_t instrId, Side side, int32_t price) {
+        return (static_cast<uint64_t>(instrId) << 33) | (static_cast<uint64_t>(side == Side::Sell) << 32) | static_cast<uint32_t>(price);
+    }
+
+    inline void flushLevels() {
+        for (size_t i = 0; i < touchedCount; ++i) {
+            uint64_t key = touchedLevels[i];
+            auto instrId = static_cast<uint16_t>(key >> 33);
+            Side side = (key >> 32) & 1 ? Side::Sell : Side::Buy;
+            auto price = static_cast<int32_t>(static_cast<uint32_t>(key));
+
+            listener.onOrderBookUpdate(instrId, price, books[instrId].getVolume(side, price), side);
+        }
+        touchedCount = 0;
+    }
+
+    // Bursts hit a few levels near the touch: the most recent entries are checked first.
+    inline void touchLevel(uint16_t instrId, Side side, int32_t price) {
+        uint64_t key = touchedKey(instrId, side, price);
+
+        for (size_t i = touchedCount; i-- > 0;) {
+            if (touchedLevels[i] == key) return;
+        }
+
+        if (touchedCount == MAX_TOUCHED_LEVELS) [[unlikely]] {
+            flushLevels();
+        }
+        touchedLevels[touchedCount++] = key;
+    }
+
+    static constexpr bool WANTS_ANALYTICS = requires(ListenerT& l, uint16_t instrId, const BookAnalytics& a) {
+        l.onAnalyticsUpdate(instrId, a);
+    };
+
+    // Optional hook: only listeners that implement onAnalyticsUpdate pay for it.
+    inline void publishAnalytics(uint16_t instrId) {
+        if constexpr (WANTS_ANALYTICS) {
+            listener.onAnalyticsUpdate(instrId, books[instrId].getAnalytics());
+        }
+    }
+
+    static constexpr bool WANTS_TRADE_PRINTS = requires(ListenerT& l, const TradePrint& t) {
+        l.onTradePrint(t);
+    };
+
+    inline void flushTrade() {
+        if constexpr (WANTS_TRADE_PRINTS) {
+            if (hasPendingTrade) {
+                listener.onTradePrint(pendingTrade);
+                hasPendingTrade = false;
+            }
+        }
+    }
+
+    // The feed has no aggressor id: a fill continues the current print as long as it hits
+    // the same instrument and resting side with the next sequence number.
+    inline void aggregateTrade(uint64_t seqNum, uint16_t instrId, Side restingSide, int32_t price, uint32_t qty) {
+        if constexpr (WANTS_TRADE_PRINTS) {
+            Side aggressor = (restingSide == Side::Buy) ? Side::Sell : Side::Buy;
+
+            if (hasPendingTrade
+                && pendingTrade.instrumentId == instrId
+                && pendingTrade.aggressorSide == aggressor
+                && pendingTrade.seqNum + pendingTrade.fills == seqNum
+                && pendingTrade.fills < UINT8_MAX) {
+                pendingTrade.lastPrice = price;
+                pendingTrade.quantity += qty;
+                ++pendingTrade.fills;
+                return;
+            }
+
+            flushTrade();
+            pendingTrade = TradePrint{seqNum, price, price, qty, instrId, aggressor, 1};
+            hasPendingTrade = true;
+        }
+    }
+
+    inline void trackOwn(uint64_t id, int32_t idx, uint64_t volumeAhead) {
+        if (ownOrders.track(id, idx, pool.link(idx), pool.info(idx), volumeAhead)) {
+            pool.setOwn(idx, true);
+        }
+    }
+
+    // Keeps queue positions current: a reduction only moves our orders that arrived later
+    // at the same level. Called before the slot can be reused.
+    inline void ownReduced(int32_t idx, uint32_t qty, bool removed) {
+        const OrderInfo& info = pool.info(idx);
+
+        ownOrders.onReduced(info.instrumentId, info.side, pool.link(idx).price, info.stamp, qty);
+
+        if (info.own && removed) {
+            ownOrders.untrack(idx, info.instrumentId, info.side, pool.link(idx).price);
+        }
+    }
+
+    // In batch mode, level updates are folded into one onOrderBookUpdate per level and one
+    // onBboUpdate per instrument per batch.
+    template<bool Batched>
+    inline void bookUpdated(uint16_t instrId, int32_t price, uint32_t newVolume, Side side) {
+        if constexpr (Batched) {
+            markDirty(instrId);
+            touchLevel(instrId, side, price);
+        }
+        else {
+            listener.onOrderBookUpdate(instrId, price, newVolume, side);
+            publishAnalytics(instrId);
+        }
+    }
+
+    template<bool Batched>
+    inline void addOrder(uint16_t instrId, uint64_t id, int32_t price, uint32_t quantity, Side side) {
         if (id >= orderIndexLookup.size()) [[unlikely]] return;
 
         int32_t idx = pool.allocate(id, price, quantity, side, instrId);
 
         if (idx == -1) [[unlikely]] return;
-        
+
         orderIndexLookup[id] = idx;
 
-        uint32_t newVolume = books[instrId].addOrder(idx, pool);
+        uint32_t newVolume = books[instrId].addOrder(idx, side, pool);
+
+        if (ownOrders.hasPending() && ownOrders.claimPending(id)) [[unlikely]] {
+            trackOwn(id, idx, newVolume - quantity);
+        }
 
         listener.onOrderAdded(instrId, id, price, quantity, side);
-        listener.onOrderBookUpdate(instrId, price, newVolume, side);
+        bookUpdated<Batched>(instrId, price, newVolume, side);
     }
 
-    inline void onCancelOrder(uint64_t id) {
+    template<bool Batched>
+    inline void cancelOrder(uint64_t id) {
         if (id >= orderIndexLookup.size()) [[unlikely]] return;
 
         int32_t idx = orderIndexLookup[id];
 
         if (idx == -1) [[unlikely]] return;
 
-        Order& order = pool.get(idx);
-        uint16_t instrId = order.instrumentId;
+        const OrderLinks& order = pool.link(idx);
+        const OrderInfo& info = pool.info(idx);
+        uint16_t instrId = info.instrumentId;
 
-        uint32_t newVolume = books[instrId].reduceVolume(order, order.quantity);
-        books[instrId].removeOrder(idx, pool);
+        uint32_t newVolume = books[instrId].reduceVolume(info.side, order.price, order.quantity);
+        books[instrId].removeOrder(idx, info.side, pool);
+
+        if (ownOrders.active()) [[unlikely]] {
+            ownReduced(idx, order.quantity, true);
+        }
 
         orderIndexLookup[id] = -1;
 
         listener.onOrderCancelled(instrId, id);
-        listener.onOrderBookUpdate(instrId, order.price, newVolume, order.side);
-        
+        bookUpdated<Batched>(instrId, order.price, newVolume, info.side);
+
         pool.deallocate(idx);
     }
 
-    inline void onOrderExecuted(uint64_t id, uint32_t executedQty) {
+    template<bool Batched>
+    inline void executeOrder(uint64_t id, uint32_t executedQty, uint64_t seqNum = 0) {
         if (id >= orderIndexLookup.size()) [[unlikely]] return;
 
         int32_t idx = orderIndexLookup[id];
 
         if (idx == -1) [[unlikely]] return;
 
-        Order& order = pool.get(idx);
-        uint16_t instrId = order.instrumentId;
+        OrderLinks& order = pool.link(idx);
+        const OrderInfo& info = pool.info(idx);
+        uint16_t instrId = info.instrumentId;
 
         uint32_t actualExecuted = std::min(order.quantity, executedQty);
         order.quantity -= actualExecuted;
 
-        int32_t newVolume = books[instrId].reduceVolume(order, actualExecuted);
+        int32_t newVolume = books[instrId].reduceVolume(info.side, order.price, actualExecuted);
+        books[instrId].onExecution(order.price, actualExecuted);
+
+        if (ownOrders.active()) [[unlikely]] {
+            ownReduced(idx, actualExecuted, order.quantity == 0);
+        }
 
         listener.onOrderExecuted(instrId, id, actualExecuted);
-        listener.onOrderBookUpdate(instrId, order.price, newVolume, order.side);
+        listener.onTrade(instrId, 0, id, order.price, actualExecuted);
+        if constexpr (Batched) {
+            aggregateTrade(seqNum, instrId, info.side, order.price, actualExecuted);
+        }
+        bookUpdated<Batched>(instrId, order.price, newVolume, info.side);
 
         if (order.quantity == 0) {
-            books[instrId].removeOrder(idx, pool);
+            books[instrId].removeOrder(idx, info.side, pool);
             orderIndexLookup[id] = -1;
             pool.deallocate(idx);
         }
     }
+
+    inline void exportDigest(uint16_t instrId) {
+        const auto& book = books[instrId];
+        BookDigest d;
+        d.seqNum = lastSeq[instrId];
+        d.bestBid = book.getBestBid();
+        d.bestAsk = book.getBestAsk();
+        d.bidVolume = book.getVolume(Side::Buy, d.bestBid);
+        d.askVolume = book.getVolume(Side::Sell, d.bestAsk);
+        d.bidOrders = book.getOrderCount(Side::Buy, d.bestBid);
+        d.askOrders = book.getOrderCount(Side::Sell, d.bestAsk);
+        d.bidHash = book.getLevelHash(Side::Buy);
+        d.askHash = book.getLevelHash(Side::Sell);
+        digests->write(instrId, d);
+    }
+
+    inline void flushBbo() {
+        for (size_t w = 0; w < DIRTY_WORDS; ++w) {
+            uint64_t mask = dirty[w];
+            dirty[w] = 0;
+
+            while (mask) {
+                auto instrId = static_cast<uint16_t>(w * 64 + std::countr_zero(mask));
+                mask &= mask - 1;
+
+                Bbo current{books[instrId].getBestBid(), books[instrId].getBestAsk()};
+                Bbo& last = lastBbo[instrId];
+
+                if (current.bid != last.bid || current.ask != last.ask) {
+                    last = current;
+                    listener.onBboUpdate(instrId, current.bid, current.ask);
+                }
+
+                publishAnalytics(instrId);
+
+                if (digests) {
+                    exportDigest(instrId);
+                }
+            }
+        }
+    }
+
+    template<bool Checked>
+    inline void applyBatch(std::span<const QueueItem> items) {
+        for (const QueueItem& item : items) {
+            if constexpr (Checked) {
+                if (item.instrumentId >= MAX_INSTRUMENTS) continue;
+            }
+
+            switch (item.type) {
+                case MsgType::AddOrder:
+                    addOrder<true>(item.instrumentId, item.id, item.price, item.quantity, item.side);
+                    break;
+                case MsgType::CancelOrder:
+                    cancelOrder<true>(item.id);
+                    break;
+                case MsgType::ExecutedOrder:
+                    executeOrder<true>(item.id, item.quantity, item.seqNum);
+                    break;
+                case MsgType::OwnOrder:
+                    registerOwnOrder(item.id, item.seqNum);
+                    break;
+            }
+
+            // Execution reports are numbered apart from the feed.
+            if (digests && item.type != MsgType::OwnOrder) {
+                lastSeq[item.instrumentId] = item.seqNum;
+            }
+        }
+    }
+
+public:
+    MarketManager(ListenerT& l)
+        : pool(MAX_LIVE_ORDERS),
+          orderIndexLookup(MAX_ORDER_IDS, -1),
+          ownOrders(MAX_INSTRUMENTS, ProfileT::MAX_PRICE, ProfileT::MAX_OWN_ORDERS),
+          listener(l) {};
+
+    inline void onAddOrder(uint16_t instrId, uint64_t id, int32_t price, uint32_t quantity, Side side) {
+        addOrder<false>(instrId, id, price, quantity, side);
+    }
+
+    inline void onCancelOrder(uint64_t id) {
+        cancelOrder<false>(id);
+    }
+
+    inline void onOrderExecuted(uint64_t id, uint32_t executedQty) {
+        executeOrder<false>(id, executedQty);
+    }
+
+    // Late join: bulk-loads an instrument's resting orders (in queue order) with no per-order
+    // callbacks, then reports each resulting level and the top of book once.
+    inline void loadSnapshot(uint16_t instrId, uint64_t seqNum, std::span<const QueueItem> orders) {
+        for (const QueueItem& o : orders) {
+            if (o.id >= orderIndexLookup.size()) [[unlikely]] continue;
+
+            int32_t idx = pool.allocate(o.id, o.price, o.quantity, o.side, instrId);
+
+            if (idx == -1) [[unlikely]] break;
+
+            orderIndexLookup[o.id] = idx;
+            books[instrId].addOrder(idx, o.side, pool);
+            touchLevel(instrId, o.side, o.price);
+        }
+
+        lastSeq[instrId] = seqNum;
+        markDirty(instrId);
+        flushLevels();
+        flushBbo();
+    }
+
+    // Execution-report side: marks `id` as ours. Orders already resting get their queue
+    // position from a one-off walk of their level; others are picked up when the feed adds
+    // them. `seqNum` numbers the reports (not the feed) and ages out ids that never show up.
+    inline void registerOwnOrder(uint64_t id, uint64_t seqNum) {
+        if (id >= orderIndexLookup.size()) [[unlikely]] return;
+
+        int32_t idx = orderIndexLookup[id];
+
+        if (idx == -1) {
+            ownOrders.expect(id, seqNum);
+            return;
+        }
+        if (pool.info(idx).own) return;
+
+        const OrderInfo& info = pool.info(idx);
+        trackOwn(id, idx, books[info.instrumentId].volumeAhead(idx, info.side, pool));
+    }
+
+    // Back to the state after construction: every resting order, own-order registration
+    // and per-batch state is dropped, without reporting anything. Costs the resting orders
+    // plus a pass over the pool, not a new engine (the fuzzer resets once per input).
+    inline void reset() {
+        for (auto& book : books) {
+            book.clear(pool, [this](int32_t idx) { orderIndexLookup[pool.info(idx).id] = -1; });
+        }
+        pool.reset();
+        ownOrders.clear();
+
+        dirty = {};
+        lastBbo.fill(Bbo{});
+        touchedCount = 0;
+        lastSeq = {};
+        pendingTrade = TradePrint{};
+        hasPendingTrade = false;
+    }
+
+    // Volume resting ahead of one of our orders, or nullopt if it is not (or no longer) in the book.
+    inline std::optional<uint64_t> getVolumeAhead(uint64_t id) const {
+        const OwnOrderTracker::OwnOrder* o = ownOrders.find(id);
+        return o ? std::optional<uint64_t>(o->volumeAhead) : std::nullopt;
+    }
+
+    inline size_t getOwnOrderCount() const {
+        return ownOrders.size();
+    }
+
+    // Digests are exported at the end of each batch for the instruments it touched.
+    inline void setDigestTable(DigestTable<MAX_INSTRUMENTS>* table) {
+        digests = table;
+    }
+
+    inline BookAnalytics getAnalytics(uint16_t instrId) const {
+        return books[instrId].getAnalytics();
+    }
+
+    template<Side S>
+    inline size_t getDepth(uint16_t instrId, std::span<DepthLevel> out) const {
+        return books[instrId].template getDepth<S>(out);
+    }
+
+    inline uint32_t getOrderCount(uint16_t instrId, Side side, int32_t price) const {
+        return books[instrId].getOrderCount(side, price);
+    }
+
+    // Applies a burst in feed order (so per-order ordering holds) and reports each touched
+    // level and each touched instrument's top of book once, at the end of the burst.
+    // Fills are also aggregated into TradePrints here: the per-message API only
+    // reports them individually through onTrade.
+    inline void onBatch(std::span<const QueueItem> items) {
+        // One pass over the burst instead of a check per item. Parser output is always in
+        // range, so the checked loop only runs for spans built by hand.
+        bool inRange = true;
+        for (const QueueItem& item : items) {
+            inRange &= item.instrumentId < MAX_INSTRUMENTS;
+        }
+
+        if (inRange) [[likely]] applyBatch<false>(items);
+        else applyBatch<true>(items);
+
+        flushTrade();
+        flushLevels();
+        flushBbo();
+    }
 };
@@ -3,6 +3,26 @@
 #include <iostream>
 #include "Messages.h"
 
+// The pool stores orders split in two arrays. OrderLinks is what the book touches on
+// every event and what removeOrder chases through prev/next: 4 per cache line.
+struct OrderLinks {
+    int32_t prev = -1;
+    int32_t next = -1;
+    uint32_t quantity;
+    int32_t price;
+};
+
+// Identity, read once per event for the order itself, never for its neighbours.
+// stamp orders arrivals: within a level, a lower stamp is ahead in the queue.
+struct OrderInfo {
+    uint64_t id;
+    uint32_t stamp;
+    uint16_t instrumentId;
+    Side side;
+    bool own;
+};
+
+// Full view of an order, assembled from both arrays (debugging, snapshots).
 struct Order {
     uint64_t id;
     int32_t price;
@@ -25,11 +45,3 @@ struct Order {
                   << order.quantity << " @ " << order.price;
     }
 };
-
-enum class RejectReason : uint8_t {
-    DuplicateId,
-    InvalidPrice,
-    InvalidQuantity,
-    OrderNotFound,
-    SystemFull
-};
\ No newline at end of file
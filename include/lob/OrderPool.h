@@ -3,39 +3,66 @@
 #include <cstdint>
 #include "Order.h"
 
+// Structure-of-arrays pool: links/quantity/price in one array, identity in another.
 class OrderPool {
 private:
-    std::vector<Order> store;
+    std::vector<OrderLinks> links;
+    std::vector<OrderInfo> infos;
     int32_t freeHead;
+    uint32_t nextStamp = 0;
 
 public:
-    explicit OrderPool(size_t size) : store(size) {
-        for(size_t i = 0; i < size - 1; ++i) {
-            store[i].next = static_cast<int32_t> (i + 1);
+    explicit OrderPool(size_t size) : links(size), infos(size) {
+        reset();
+    }
+
+    // Every slot free again, handed out in the same order as after construction.
+    void reset() {
+        for(size_t i = 0; i < links.size() - 1; ++i) {
+            links[i].next = static_cast<int32_t> (i + 1);
         }
-        store [size - 1].next = -1;
+        links [links.size() - 1].next = -1;
 
         freeHead= 0;
+        nextStamp = 0;
     }
 
-    template<typename... Args>
-    int32_t allocate(Args&&... args) {
+    int32_t allocate(uint64_t id, int32_t price, uint32_t quantity, Side side, uint16_t instId) {
         if (freeHead == -1) [[unlikely]] return -1;
 
         int32_t idx = freeHead;
-        freeHead = store[idx].next;
+        freeHead = links[idx].next;
 
-        new (&store[idx]) Order(std::forward<Args>(args)...);
+        links[idx] = OrderLinks{-1, -1, quantity, price};
+        infos[idx] = OrderInfo{id, nextStamp++, instId, side, false};
 
         return idx;
     }
 
     void deallocate(int32_t idx) {
-        store[idx].next = freeHead;
+        links[idx].next = freeHead;
         freeHead = idx;
     }
 
-    inline Order& get(int32_t idx) {
-        return store[idx];
+    inline OrderLinks& link(int32_t idx) {
+        return links[idx];
+    }
+
+    inline const OrderInfo& info(int32_t idx) const {
+        return infos[idx];
+    }
+
+    inline void setOwn(int32_t idx, bool own) {
+        infos[idx].own = own;
+    }
+
+    Order get(int32_t idx) const {
+        const OrderLinks& l = links[idx];
+        const OrderInfo& i = infos[idx];
+
+        Order order(i.id, l.price, l.quantity, i.side, i.instrumentId);
+        order.prev = l.prev;
+        order.next = l.next;
+        return order;
     }
-};
\ No newline at end of file
+};
@@ -0,0 +1,260 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <vector>
+#include "Order.h"
+
+// Fixed-capacity uint64 -> uint64 map: open addressing, linear probing, backward-shift
+// deletion. All storage is allocated up front; the engine core never allocates.
+class FixedIdMap {
+private:
+    struct Entry {
+        uint64_t key;
+        uint64_t value;
+    };
+
+    static constexpr uint64_t EMPTY = UINT64_MAX;
+
+    std::vector<Entry> slots;
+    size_t mask;
+    size_t shift;
+    size_t capacity;
+    size_t count = 0;
+
+    size_t home(uint64_t key) const {
+        return static_cast<size_t>((key * UINT64_C(0x9E3779B97F4A7C15)) >> shift);
+    }
+
+    size_t locate(uint64_t key) const {
+        for (size_t i = home(key);; i = (i + 1) & mask) {
+            if (slots[i].key == key || slots[i].key == EMPTY) return i;
+        }
+    }
+
+    // Shifts later entries of the probe run back into the hole at `i`.
+    void eraseAt(size_t i) {
+        for (size_t j = (i + 1) & mask; slots[j].key != EMPTY; j = (j + 1) & mask) {
+            size_t h = home(slots[j].key);
+            // Movable unless its home lies cyclically in (i, j].
+            if (((j - h) & mask) >= ((j - i) & mask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i].key = EMPTY;
+        --count;
+    }
+
+public:
+    // At most half full, so probe runs stay short.
+    explicit FixedIdMap(size_t capacity)
+        : slots(std::bit_ceil(capacity * 2), Entry{EMPTY, 0}),
+          mask(slots.size() - 1),
+          shift(64 - std::countr_zero(slots.size())),
+          capacity(capacity) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count >= capacity; }
+
+    void clear() {
+        std::fill(slots.begin(), slots.end(), Entry{EMPTY, 0});
+        count = 0;
+    }
+
+    uint64_t* find(uint64_t key) {
+        Entry& e = slots[locate(key)];
+        return e.key == key ? &e.value : nullptr;
+    }
+
+    const uint64_t* find(uint64_t key) const {
+        const Entry& e = slots[locate(key)];
+        return e.key == key ? &e.value : nullptr;
+    }
+
+    // Inserts or overwrites. False if `key` is new and the map is full.
+    bool insert(uint64_t key, uint64_t value) {
+        Entry& e = slots[locate(key)];
+        if (e.key == EMPTY) {
+            if (full()) return false;
+            e.key = key;
+            ++count;
+        }
+        e.value = value;
+        return true;
+    }
+
+    bool erase(uint64_t key) {
+        size_t i = locate(key);
+        if (slots[i].key != key) return false;
+        eraseAt(i);
+        return true;
+    }
+
+    // An entry shifted into the current slot is tested again; none is skipped.
+    template<typename Pred>
+    void eraseIf(Pred pred) {
+        for (size_t i = 0; i < slots.size(); ) {
+            if (slots[i].key != EMPTY && pred(slots[i].key, slots[i].value)) eraseAt(i);
+            else ++i;
+        }
+    }
+};
+
+// Queue position of our own resting orders. Each tracked order keeps the volume resting
+// ahead of it at its level, updated when an earlier order at that level is reduced.
+// Tracked orders are chained per level, and a bitmap marks the levels holding any: an
+// event elsewhere costs one bit test, an event on a marked level O(own orders there).
+// Capacity is fixed by the profile (MAX_OWN_ORDERS); past it, new orders go untracked.
+class OwnOrderTracker {
+public:
+    struct OwnOrder {
+        uint64_t id;
+        int32_t idx;
+        int32_t price;
+        uint32_t stamp;
+        uint16_t instrumentId;
+        Side side;
+        uint64_t volumeAhead;
+    };
+
+private:
+    struct Slot {
+        OwnOrder order;
+        int32_t prev;
+        int32_t next; // also the free list
+    };
+
+    // Acknowledged by the execution reports but not seen on the feed yet, with the report's
+    // seqNum. Reports are numbered apart from the public feed. Ids that never show up
+    // (already gone, rejected by the parser) expire after PENDING_WINDOW reports, checked
+    // once the table is full.
+    static constexpr uint64_t PENDING_WINDOW = 1 << 16;
+
+    FixedIdMap pending;
+
+    size_t pricesPerSide;
+    std::vector<uint64_t> levelMarks;
+
+    std::vector<Slot> slots;
+    int32_t freeSlot = 0;
+    FixedIdMap levelHead; // level key -> first slot
+    FixedIdMap slotOf;    // order id -> slot
+
+    // Also the level's bit in levelMarks.
+    size_t levelKey(uint16_t instrId, Side side, int32_t price) const {
+        return (static_cast<size_t>(instrId) * 2 + (side == Side::Sell)) * pricesPerSide + static_cast<size_t>(price);
+    }
+
+    bool marked(size_t key) const {
+        return levelMarks[key / 64] & (UINT64_C(1) << (key & 63));
+    }
+
+    int32_t head(size_t key) const {
+        const uint64_t* h = levelHead.find(key);
+        return h ? static_cast<int32_t>(*h) : -1;
+    }
+
+public:
+    OwnOrderTracker(size_t instruments, int32_t maxPrice, size_t capacity)
+        : pending(capacity),
+          pricesPerSide(static_cast<size_t>(maxPrice) + 1),
+          levelMarks((instruments * 2 * pricesPerSide + 63) / 64),
+          slots(capacity),
+          levelHead(capacity),
+          slotOf(capacity)
+    {
+        clear();
+    }
+
+    // Forgets every tracked order and pending registration.
+    void clear() {
+        pending.clear();
+        levelHead.clear();
+        slotOf.clear();
+        std::fill(levelMarks.begin(), levelMarks.end(), 0);
+
+        for (size_t i = 0; i < slots.size(); ++i) {
+            slots[i].next = i + 1 < slots.size() ? static_cast<int32_t>(i + 1) : -1;
+        }
+        freeSlot = slots.empty() ? -1 : 0;
+    }
+
+    bool active() const { return !slotOf.empty(); }
+    bool hasPending() const { return !pending.empty(); }
+    size_t size() const { return slotOf.size(); }
+
+    // False if the table is full of registrations still inside the window.
+    bool expect(uint64_t id, uint64_t seqNum) {
+        if (pending.full()) {
+            pending.eraseIf([seqNum](uint64_t, uint64_t seen) { return seen + PENDING_WINDOW < seqNum; });
+        }
+
+        return pending.insert(id, seqNum);
+    }
+
+    // Consumes a pending registration for `id`, if any.
+    bool claimPending(uint64_t id) {
+        return pending.erase(id);
+    }
+
+    // False if every slot is taken: the order stays untracked.
+    bool track(uint64_t id, int32_t idx, const OrderLinks& links, const OrderInfo& info, uint64_t volumeAhead) {
+        if (freeSlot == -1) [[unlikely]] return false;
+
+        size_t key = levelKey(info.instrumentId, info.side, links.price);
+        int32_t s = freeSlot;
+        int32_t first = head(key);
+
+        freeSlot = slots[s].next;
+        slots[s] = {{id, idx, links.price, info.stamp, info.instrumentId, info.side, volumeAhead}, -1, first};
+        if (first != -1) slots[first].prev = s;
+
+        levelHead.insert(key, static_cast<uint64_t>(s));
+        slotOf.insert(id, static_cast<uint64_t>(s));
+        levelMarks[key / 64] |= UINT64_C(1) << (key & 63);
+        return true;
+    }
+
+    void untrack(int32_t idx, uint16_t instrId, Side side, int32_t price) {
+        size_t key = levelKey(instrId, side, price);
+        if (!marked(key)) return;
+
+        int32_t s = head(key);
+        while (s != -1 && slots[s].order.idx != idx) s = slots[s].next;
+        if (s == -1) return;
+
+        Slot& slot = slots[s];
+        if (slot.prev != -1) slots[slot.prev].next = slot.next;
+        else if (slot.next != -1) levelHead.insert(key, static_cast<uint64_t>(slot.next));
+        else {
+            levelHead.erase(key);
+            levelMarks[key / 64] &= ~(UINT64_C(1) << (key & 63));
+        }
+        if (slot.next != -1) slots[slot.next].prev = slot.prev;
+
+        slotOf.erase(slot.order.id);
+        slot.next = freeSlot;
+        freeSlot = s;
+    }
+
+    // `qty` left the level at (instrId, side, price) from an order that arrived at `stamp`.
+    void onReduced(uint16_t instrId, Side side, int32_t price, uint32_t stamp, uint32_t qty) {
+        size_t key = levelKey(instrId, side, price);
+        if (!marked(key)) return;
+
+        for (int32_t s = head(key); s != -1; s = slots[s].next) {
+            OwnOrder& o = slots[s].order;
+            // Stamps wrap: compare by signed distance.
+            if (static_cast<int32_t>(o.stamp - stamp) > 0) {
+                o.volumeAhead -= std::min<uint64_t>(o.volumeAhead, qty);
+            }
+        }
+    }
+
+    const OwnOrder* find(uint64_t id) const {
+        const uint64_t* s = slotOf.find(id);
+        return s ? &slots[*s].order : nullptr;
+    }
+};
@@ -1,9 +1,15 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <span>
 #include <vector>
 #include "Order.h"
 #include "OrderPool.h"
 #include "BboBitset.h"
+#include "BookAnalytics.h"
+#include "BookDigest.h"
 
+template<int32_t MAX_PRICE>
 class PassiveOrderBook {
 private:
 
@@ -11,66 +17,92 @@ private:
         int32_t head = -1;
         int32_t tail = -1;
         uint32_t totalVolume = 0;
+        uint32_t orderCount = 0;
     };
 
-    // We assume prices between 0 and 100,000.
-    static constexpr size_t MAX_PRICE = 100000;
+    static constexpr size_t VWAP_WINDOW = 64;
+    static constexpr size_t MAX_DEPTH = 64;
+
+    // Prices between 0 and MAX_PRICE, set by the engine profile.
     std::vector<Level> bids;
     std::vector<Level> asks;
 
-    BboBitset bidPrices;
-    BboBitset askPrices;
+    BboBitset<MAX_PRICE> bidPrices;
+    BboBitset<MAX_PRICE> askPrices;
+
+    RollingVwap<VWAP_WINDOW> vwap;
+
+    // Sum of levelHash over each side's levels, for the verifier digest.
+    uint64_t bidHash = 0;
+    uint64_t askHash = 0;
+
+    const Level& level(Side side, int32_t price) const {
+        return (side == Side::Buy) ? bids[price] : asks[price];
+    }
+
+    void rehash(Side side, int32_t price, uint32_t oldVolume, uint32_t oldOrders, const Level& now) {
+        uint64_t& hash = (side == Side::Buy) ? bidHash : askHash;
+        hash += levelHash(price, now.totalVolume, now.orderCount) - levelHash(price, oldVolume, oldOrders);
+    }
 
 public:
 
     PassiveOrderBook(): bids(MAX_PRICE + 1), asks(MAX_PRICE + 1) {};
 
-    uint32_t addOrder(int32_t idx, OrderPool& pool) {
-        Order& order = pool.get(idx);
-        std::vector<Level>& bookSide = (order.side == Side::Buy) ? bids: asks;
+    // Only touches the hot OrderLinks array: the caller already read the side.
+    uint32_t addOrder(int32_t idx, Side side, OrderPool& pool) {
+        OrderLinks& order = pool.link(idx);
+        std::vector<Level>& bookSide = (side == Side::Buy) ? bids: asks;
         Level& level = bookSide[order.price];
-                
+        const uint32_t oldVolume = level.totalVolume;
+        const uint32_t oldOrders = level.orderCount;
+
         if (level.head == -1) {
             level.head = idx;
             level.tail = idx;
         }
         else {
-            pool.get(level.tail).next = idx;
-            pool.get(idx).prev = level.tail;
+            pool.link(level.tail).next = idx;
+            order.prev = level.tail;
             level.tail = idx;
         }
 
         level.totalVolume += order.quantity;
+        ++level.orderCount;
+        rehash(side, order.price, oldVolume, oldOrders, level);
 
         if (level.totalVolume == order.quantity) {
-            if (order.side == Side::Buy) bidPrices.setPrice(order.price);
+            if (side == Side::Buy) bidPrices.setPrice(order.price);
             else askPrices.setPrice(order.price);
         }
 
         return level.totalVolume;
     }
 
-    uint32_t removeOrder(uint32_t idx, OrderPool& pool) {
-        Order& order = pool.get(idx);
-        std::vector<Level>& bookSide = (order.side == Side::Buy) ? bids: asks;
+    uint32_t removeOrder(int32_t idx, Side side, OrderPool& pool) {
+        OrderLinks& order = pool.link(idx);
+        std::vector<Level>& bookSide = (side == Side::Buy) ? bids: asks;
         Level& level = bookSide[order.price];
 
         if (order.prev != -1) {
-            pool.get(order.prev).next = order.next;
+            pool.link(order.prev).next = order.next;
         }
         else {
             level.head = order.next;
         }
         
         if (order.next != -1) {
-            pool.get(order.next).prev = order.prev;
+            pool.link(order.next).prev = order.prev;
         }
         else {
             level.tail = order.prev;
         }
 
+        --level.orderCount;
+        rehash(side, order.price, level.totalVolume, level.orderCount + 1, level);
+
         if (level.totalVolume == 0) {
-            if (order.side == Side::Buy) bidPrices.clearPrice(order.price);
+            if (side == Side::Buy) bidPrices.clearPrice(order.price);
             else askPrices.clearPrice(order.price);
         }
 
@@ -80,9 +112,89 @@ public:
     int getBestBid() const { return bidPrices.getBestBid(); }
     int getBestAsk() const { return askPrices.getBestAsk(); }
 
-    uint32_t reduceVolume(Order& order, uint32_t qty) {
-        std::vector<Level>& bookSide = (order.side == Side::Buy) ? bids: asks;
-        bookSide[order.price].totalVolume -= qty;
-        return bookSide[order.price].totalVolume;
+    uint32_t getVolume(Side side, int32_t price) const { return level(side, price).totalVolume; }
+    uint32_t getOrderCount(Side side, int32_t price) const { return level(side, price).orderCount; }
+    uint64_t getLevelHash(Side side) const { return (side == Side::Buy) ? bidHash : askHash; }
+
+    // O(queue position) walk from the head of the order's level. Only for orders that
+    // become tracked after they joined the book; the tracker keeps it up to date after that.
+    uint64_t volumeAhead(int32_t idx, Side side, OrderPool& pool) const {
+        uint64_t volume = 0;
+
+        for (int32_t cur = level(side, pool.link(idx).price).head; cur != -1 && cur != idx; cur = pool.link(cur).next) {
+            volume += pool.link(cur).quantity;
+        }
+        return volume;
+    }
+
+    // Best `out.size()` levels of one side, walked through the bitset instead of the level arrays.
+    template<Side S>
+    size_t getDepth(std::span<DepthLevel> out) const {
+        const auto& prices = (S == Side::Buy) ? bidPrices : askPrices;
+        const auto& bookSide = (S == Side::Buy) ? bids : asks;
+
+        std::array<int32_t, MAX_DEPTH> buffer;
+        size_t n = prices.template top<S>(std::span(buffer).first(std::min(out.size(), MAX_DEPTH)));
+
+        for (size_t i = 0; i < n; ++i) {
+            const Level& level = bookSide[buffer[i]];
+            out[i] = {buffer[i], level.totalVolume, level.orderCount};
+        }
+        return n;
+    }
+
+    void onExecution(int32_t price, uint32_t qty) { vwap.onExecution(price, qty); }
+
+    // O(1): two bitset lookups and two level reads.
+    BookAnalytics getAnalytics() const {
+        BookAnalytics a{};
+        a.bestBid = getBestBid();
+        a.bestAsk = getBestAsk();
+
+        const Level& bid = bids[a.bestBid];
+        const Level& ask = asks[a.bestAsk];
+        a.bidVolume = bid.totalVolume;
+        a.askVolume = ask.totalVolume;
+        a.bidOrders = bid.orderCount;
+        a.askOrders = ask.orderCount;
+
+        double touchVolume = static_cast<double>(a.bidVolume) + a.askVolume;
+        if (touchVolume > 0) {
+            a.imbalance = (static_cast<double>(a.bidVolume) - a.askVolume) / touchVolume;
+        }
+        if (a.bidVolume && a.askVolume) {
+            a.microprice = (static_cast<double>(a.bestBid) * a.askVolume + static_cast<double>(a.bestAsk) * a.bidVolume) / touchVolume;
+        }
+
+        a.vwap = vwap.value();
+        return a;
+    }
+
+    // Empties both sides, handing each resting order to `drop`. O(levels + orders): only
+    // populated levels are visited. The caller frees the slots.
+    template<typename DropT>
+    void clear(OrderPool& pool, DropT&& drop) {
+        for (Side side : {Side::Buy, Side::Sell}) {
+            std::vector<Level>& bookSide = (side == Side::Buy) ? bids : asks;
+            BboBitset<MAX_PRICE>& prices = (side == Side::Buy) ? bidPrices : askPrices;
+
+            for (int32_t p = prices.nextLower(MAX_PRICE + 1); p != prices.NONE; p = prices.nextLower(p)) {
+                for (int32_t idx = bookSide[p].head; idx != -1; idx = pool.link(idx).next) drop(idx);
+                bookSide[p] = Level{};
+                prices.clearPrice(p);
+            }
+        }
+
+        bidHash = 0;
+        askHash = 0;
+        vwap = RollingVwap<VWAP_WINDOW>{};
+    }
+
+    uint32_t reduceVolume(Side side, int32_t price, uint32_t qty) {
+        std::vector<Level>& bookSide = (side == Side::Buy) ? bids: asks;
+        Level& level = bookSide[price];
+        level.totalVolume -= qty;
+        rehash(side, price, level.totalVolume + qty, level.orderCount, level);
+        return level.totalVolume;
     }
 };
\ No newline at end of file
@@ -0,0 +1,220 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <print>
+#include <unordered_map>
+#include <vector>
+#include "EngineConfig.h"
+#include "Globals.h"
+#include "Messages.h"
+#include "Utils.h"
+#include "WaitStrategy.h"
+#include "BookDigest.h"
+
+// Reference book rebuilt from a tap of the engine's input, with plain std containers.
+// Runs on its own core and compares itself against the engine's digests whenever both
+// have applied exactly the same messages for an instrument: the touch field by field,
+// the deeper levels through the per-side hash.
+template<EngineProfileConcept ProfileT>
+class ShadowVerifier {
+private:
+    static constexpr size_t MAX_INSTRUMENTS = ProfileT::MAX_INSTRUMENTS;
+    static constexpr size_t VERIFY_EVERY = 1024;
+    static constexpr uint64_t MAX_REPORTS = 100;
+
+    struct RefOrder {
+        uint16_t instrumentId;
+        Side side;
+        int32_t price;
+        uint32_t quantity;
+    };
+
+    struct RefLevel {
+        uint64_t volume = 0;
+        uint32_t orders = 0;
+    };
+
+    struct RefBook {
+        std::map<int32_t, RefLevel> bids;
+        std::map<int32_t, RefLevel> asks;
+        uint64_t seqNum = 0;
+        uint64_t lastVerifiedSeq = 0;
+    };
+
+    std::unordered_map<uint64_t, RefOrder> orders;
+    std::vector<RefBook> books;
+
+    uint64_t checks = 0;
+    uint64_t mismatches = 0;
+    uint64_t crossedBooks = 0;
+    bool desynced = false;
+
+    std::map<int32_t, RefLevel>& sideOf(RefBook& book, Side side) {
+        return (side == Side::Buy) ? book.bids : book.asks;
+    }
+
+    void removeVolume(const RefOrder& order, uint32_t qty, bool removeOrder) {
+        auto& levels = sideOf(books[order.instrumentId], order.side);
+        auto it = levels.find(order.price);
+        if (it == levels.end()) return;
+
+        it->second.volume -= qty;
+        if (removeOrder) --it->second.orders;
+        if (it->second.orders == 0) levels.erase(it);
+    }
+
+    static uint64_t hashOf(const std::map<int32_t, RefLevel>& levels) {
+        uint64_t hash = 0;
+        for (const auto& [price, level] : levels) {
+            hash += levelHash(price, level.volume, level.orders);
+        }
+        return hash;
+    }
+
+    void mismatch(uint16_t instrId, const char* what, int64_t engine, int64_t reference) {
+        if (mismatches++ < MAX_REPORTS) {
+            std::println(stderr, "[VERIFY] Instr {} {} mismatch: engine {} vs reference {} (seq {})",
+                         instrId, what, engine, reference, books[instrId].seqNum);
+        }
+    }
+
+    void compare(uint16_t instrId, const BookDigest& d) {
+        RefBook& book = books[instrId];
+        ++checks;
+
+        int32_t refBid = book.bids.empty() ? 0 : book.bids.rbegin()->first;
+        int32_t refAsk = book.asks.empty() ? ProfileT::MAX_PRICE : book.asks.begin()->first;
+
+        if (d.bestBid != refBid) mismatch(instrId, "best bid", d.bestBid, refBid);
+        if (d.bestAsk != refAsk) mismatch(instrId, "best ask", d.bestAsk, refAsk);
+
+        // Not an engine/reference disagreement, but a book no venue should ever publish.
+        if (!book.bids.empty() && !book.asks.empty() && d.bestBid >= d.bestAsk) {
+            if (crossedBooks++ < MAX_REPORTS) {
+                std::println(stderr, "[VERIFY] Instr {} crossed book: {} / {} (seq {})", instrId, d.bestBid, d.bestAsk, d.seqNum);
+            }
+        }
+
+        if (!book.bids.empty()) {
+            const RefLevel& bid = book.bids.rbegin()->second;
+            if (d.bidVolume != bid.volume) mismatch(instrId, "bid volume", d.bidVolume, bid.volume);
+            if (d.bidOrders != bid.orders) mismatch(instrId, "bid orders", d.bidOrders, bid.orders);
+        }
+
+        if (!book.asks.empty()) {
+            const RefLevel& ask = book.asks.begin()->second;
+            if (d.askVolume != ask.volume) mismatch(instrId, "ask volume", d.askVolume, ask.volume);
+            if (d.askOrders != ask.orders) mismatch(instrId, "ask orders", d.askOrders, ask.orders);
+        }
+
+        // Every level, not just the touch: catches a wrong deep level or order count.
+        uint64_t bidHash = hashOf(book.bids);
+        uint64_t askHash = hashOf(book.asks);
+        if (d.bidHash != bidHash) mismatch(instrId, "bid levels hash", static_cast<int64_t>(d.bidHash), static_cast<int64_t>(bidHash));
+        if (d.askHash != askHash) mismatch(instrId, "ask levels hash", static_cast<int64_t>(d.askHash), static_cast<int64_t>(askHash));
+
+        book.lastVerifiedSeq = d.seqNum;
+    }
+
+public:
+    ShadowVerifier() : books(MAX_INSTRUMENTS) {}
+
+    // Mirrors MarketManager's semantics, except that a reused id replaces the old order
+    // instead of leaking it: the engine doing otherwise is exactly what we want to see.
+    void apply(const QueueItem& item) {
+        if (item.instrumentId >= MAX_INSTRUMENTS || item.id >= ProfileT::MAX_ORDER_IDS) return;
+
+        switch (item.type) {
+            case MsgType::AddOrder: {
+                if (auto it = orders.find(item.id); it != orders.end()) {
+                    removeVolume(it->second, it->second.quantity, true);
+                }
+
+                RefOrder order{item.instrumentId, item.side, item.price, item.quantity};
+                orders[item.id] = order;
+
+                RefLevel& level = sideOf(books[order.instrumentId], order.side)[order.price];
+                level.volume += order.quantity;
+                ++level.orders;
+                break;
+            }
+            case MsgType::CancelOrder: {
+                auto it = orders.find(item.id);
+                if (it == orders.end()) break;
+
+                removeVolume(it->second, it->second.quantity, true);
+                orders.erase(it);
+                break;
+            }
+            case MsgType::ExecutedOrder: {
+                auto it = orders.find(item.id);
+                if (it == orders.end()) break;
+
+                RefOrder& order = it->second;
+                uint32_t executed = std::min(order.quantity, item.quantity);
+                order.quantity -= executed;
+
+                removeVolume(order, executed, order.quantity == 0);
+                if (order.quantity == 0) orders.erase(it);
+                break;
+            }
+            case MsgType::OwnOrder:
+                break; // ownership doesn't change the book
+        }
+
+        books[item.instrumentId].seqNum = item.seqNum;
+    }
+
+    // Compares every instrument whose digest is at the same sequence number as our book.
+    void verify(const DigestTable<MAX_INSTRUMENTS>& digests) {
+        if (desynced) return;
+
+        for (size_t i = 0; i < MAX_INSTRUMENTS; ++i) {
+            auto instrId = static_cast<uint16_t>(i);
+            BookDigest d;
+
+            if (!digests.read(instrId, d)) continue;
+            if (d.seqNum != books[i].seqNum || d.seqNum == books[i].lastVerifiedSeq) continue;
+
+            compare(instrId, d);
+        }
+    }
+
+    template<typename RingT, typename WaitT = FutexWait<>>
+    void run(RingT& tap, const DigestTable<MAX_INSTRUMENTS>& digests, const std::atomic<uint64_t>& tapDrops, int coreId) {
+        pin_to_core(coreId);
+        std::println("Verifier started...");
+
+        WaitT wait;
+        uint64_t applied = 0;
+
+        while (running) {
+            if (!desynced && tapDrops.load(std::memory_order_relaxed) != 0) [[unlikely]] {
+                desynced = true;
+                std::println(stderr, "[VERIFY] Tap overflowed, reference book lost sync. Checks disabled.");
+            }
+
+            QueueItem* item = tap.peek();
+            if (!item) {
+                verify(digests);
+                wait.idle(tap);
+                continue;
+            }
+            wait.reset();
+
+            apply(*item);
+            tap.advance();
+
+            if (++applied % VERIFY_EVERY == 0) {
+                verify(digests);
+            }
+        }
+
+        std::println("[VERIFY] {} checks, {} mismatches, {} crossed books", checks, mismatches, crossedBooks);
+    }
+
+    uint64_t getMismatches() const { return mismatches; }
+    uint64_t getCrossedBooks() const { return crossedBooks; }
+};
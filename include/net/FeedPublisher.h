@@ -0,0 +1,62 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <immintrin.h>
+#include "NetworkConcepts.h"
+#include "Messages.h"
+
+// Parses one packet straight into the ring (plus the optional tap). Shared by every loop
+// that feeds a ring: NetworkProducer for a single feed, FeedScheduler for several.
+template<typename RingT>
+class FeedPublisher {
+private:
+    RingT& ringBuffer;
+
+    // Optional copy of every parsed item for off-core consumers. Never blocks: a full tap drops.
+    RingT* tap = nullptr;
+    std::atomic<uint64_t> tapDrops{0};
+
+public:
+    explicit FeedPublisher(RingT& ring) : ringBuffer(ring) {}
+
+    void setTap(RingT* tapRing) {
+        tap = tapRing;
+    }
+
+    const std::atomic<uint64_t>& getTapDrops() const {
+        return tapDrops;
+    }
+
+    template<MessageParserConcept ParserT>
+    inline bool publish(ParserT& parser, const char* packet_ptr, size_t len) {
+        QueueItem* slot = nullptr;
+
+        if constexpr (RingT::MULTI_PRODUCER) {
+            // A claimed slot can't be handed back: parse first, claim only for a valid item.
+            QueueItem item;
+            if (!parser.parse(packet_ptr, len, &item)) return false;
+
+            while (!(slot = ringBuffer.claim())) {
+                _mm_pause();
+            };
+            *slot = item;
+        }
+        else {
+            while (!(slot = ringBuffer.claim())) {
+                _mm_pause();
+            };
+
+            if (!parser.parse(packet_ptr, len, slot)) return false;
+        }
+
+        if (tap) {
+            if (!tap->push(*slot)) [[unlikely]] {
+                tapDrops.fetch_add(1, std::memory_order_relaxed);
+            }
+            tap->wake();
+        }
+        ringBuffer.publish(slot);
+        ringBuffer.wake();
+        return true;
+    }
+};
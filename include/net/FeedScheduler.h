@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <print>
+#include <tuple>
+#include "NetworkConcepts.h"
+#include "FeedPublisher.h"
+#include "Messages.h"
+#include "Utils.h"
+#include "WaitStrategy.h"
+#include "Globals.h"
+
+// One receiver/parser pair run by a FeedScheduler. A feed is polled every 2^Priority
+// rounds (0: every round) and drains at most Budget packets per poll, so a busy feed
+// can't starve the others and a quiet one doesn't cost a receive() every round.
+template<MessageParserConcept ParserT, PacketReceiverConcept ReceiverT, unsigned Priority = 0, size_t Budget = 32>
+class Feed {
+private:
+    ParserT parser;
+    ReceiverT receiver;
+
+public:
+    static constexpr unsigned PRIORITY = Priority;
+    static constexpr size_t BUDGET = Budget;
+
+    static_assert(Priority < 64, "Priority is a shift of the round counter");
+    static_assert(Budget > 0, "A feed with no budget is never drained");
+
+    template<typename... Args>
+    explicit Feed(ParserT parser_inst, Args&&... receiver_args)
+        : parser(parser_inst),
+          receiver(std::forward<Args>(receiver_args)...) {}
+
+    template<typename PublisherT>
+    inline size_t poll(PublisherT& publisher) {
+        size_t n = 0;
+
+        for (; n < Budget; ++n) {
+            size_t len = 0;
+            const char* packet_ptr = receiver.receive(len);
+            if (!packet_ptr) break;
+
+            publisher.publish(parser, packet_ptr, len);
+        }
+        return n;
+    }
+
+    void reportRejects(size_t index) const {
+        if constexpr (requires { parser.getRejects(); }) {
+            parser.getRejects().report("FEED " + std::to_string(index));
+        }
+    }
+};
+
+template<typename T>
+concept FeedConcept = requires { T::PRIORITY; T::BUDGET; };
+
+// Several heterogeneous feeds on one network core, as a fixed round-robin state machine:
+// no coroutine frames, no allocation, and no syscalls beyond the receivers' own.
+// Feeds are polled in declaration order within a round, so declare the most urgent first.
+// The scheduler only pauses once a whole round came back empty.
+template<typename RingT, typename WaitT, FeedConcept... Feeds>
+class FeedScheduler {
+    static_assert(sizeof...(Feeds) > 0, "Nothing to schedule");
+    static_assert(sizeof...(Feeds) <= MAX_FEEDS, "More feeds than engine slices");
+
+private:
+    std::tuple<Feeds&...> feeds;
+    FeedPublisher<RingT> publisher;
+    WaitT wait;
+
+    template<typename FeedT>
+    inline size_t pollIfDue(FeedT& feed, uint64_t round) {
+        constexpr uint64_t mask = (UINT64_C(1) << FeedT::PRIORITY) - 1;
+
+        if ((round & mask) != 0) return 0;
+        return feed.poll(publisher);
+    }
+
+public:
+    explicit FeedScheduler(RingT& ring, Feeds&... f) : feeds(f...), publisher(ring) {}
+
+    void setTap(RingT* tapRing) {
+        publisher.setTap(tapRing);
+    }
+
+    const std::atomic<uint64_t>& getTapDrops() const {
+        return publisher.getTapDrops();
+    }
+
+    void run(int coreId) {
+        pin_to_core(coreId);
+        std::println("Network thread listening on {} feeds...", sizeof...(Feeds));
+
+        uint64_t round = 0;
+
+        while (running) {
+            size_t received = std::apply([&](auto&... feed) {
+                return (pollIfDue(feed, round) + ...);
+            }, feeds);
+
+            ++round;
+
+            if (received == 0) {
+                wait.pause();
+                continue;
+            }
+            wait.reset();
+        }
+
+        std::apply([](const auto&... feed) {
+            size_t index = 0;
+            (feed.reportRejects(index++), ...);
+        }, feeds);
+    }
+};
@@ -1,25 +1,37 @@
 #pragma once
 #include <print>
-#include <immintrin.h>
 #include "NetworkConcepts.h"
+#include "FeedPublisher.h"
 #include "Utils.h"
 #include "RingBuffer.h"
+#include "WaitStrategy.h"
 #include "Globals.h"
 
-template<MessageParserConcept ParserT, PacketReceiverConcept ReceiverT>
+template<MessageParserConcept ParserT, PacketReceiverConcept ReceiverT, typename RingT, typename WaitT = BusySpinWait>
 class NetworkProducer {
 private:
     ParserT parser;
     ReceiverT receiver;
+    FeedPublisher<RingT> publisher;
+    WaitT wait;
 public:
 
     template<typename... Args>
-    explicit NetworkProducer(ParserT parser_inst, Args&&... receiver_args) 
+    explicit NetworkProducer(RingT& ring, ParserT parser_inst, Args&&... receiver_args) 
         : parser(parser_inst),
-          receiver(std::forward<Args>(receiver_args)...) {}
+          receiver(std::forward<Args>(receiver_args)...),
+          publisher(ring) {}
 
-    void run() {
-        pin_to_core(4);
+    void setTap(RingT* tapRing) {
+        publisher.setTap(tapRing);
+    }
+
+    const std::atomic<uint64_t>& getTapDrops() const {
+        return publisher.getTapDrops();
+    }
+
+    void run(int coreId) {
+        pin_to_core(coreId);
         std::println("Network thread listening...");
 
         while (running) {
@@ -27,18 +39,16 @@ public:
             const char* packet_ptr = receiver.receive(len);
 
             if (!packet_ptr) {
-                _mm_pause();
+                wait.pause();
                 continue;
             }
+            wait.reset();
 
-            QueueItem* slot = nullptr;
-            while (!(slot = ringBuffer.claim())) {
-                _mm_pause();
-            };
+            publisher.publish(parser, packet_ptr, len);
+        }
 
-            if (parser.parse(packet_ptr, len, slot))  {
-                ringBuffer.publish();
-            }
-        }   
+        if constexpr (requires { parser.getRejects(); }) {
+            parser.getRejects().report("FEED");
+        }
     }
-};
\ No newline at end of file
+};
@@ -2,11 +2,20 @@
 #include <bit>
 #include <cstddef>
 #include "SimProtocol.h"
+#include "EngineConfig.h"
 #include "Messages.h"
+#include "Validation.h"
 
+// Every item that leaves the parser is in range for the engine's profile: a malformed
+// packet is counted and dropped here instead of indexing past the book arrays.
+// Accepted items are then mapped into the feed's slice of the engine and tagged with its id.
+template<EngineProfileConcept ProfileT>
 class SimParser {
-public:
-    inline bool parse(const char* packet_ptr, size_t len, QueueItem* slot) {
+private:
+    FeedSlice slice;
+    RejectCounters rejects;
+
+    inline bool decode(const char* packet_ptr, size_t len, QueueItem* slot) {
         if (len < sizeof(Sim::PacketHeader)) return false;
 
         const Sim::PacketHeader* header = reinterpret_cast<const Sim::PacketHeader*>(packet_ptr);
@@ -19,7 +28,7 @@ public:
             slot->quantity = std::byteswap(msg->quantity);
             slot->instrumentId = std::byteswap(header->instrumentId);
             slot->type = MsgType::AddOrder;
-            slot->side = (msg->side == 'B') ? Side::Buy : Side::Sell;
+            slot->side = static_cast<Side>(msg->side);
             return true;
         }
         else if (header->type == MsgType::CancelOrder && len >= sizeof(Sim::CancelOrderMsg))  {
@@ -39,7 +48,53 @@ public:
             slot->type = MsgType::ExecutedOrder;
             return true;
         }
+        else if (header->type == MsgType::OwnOrder && len >= sizeof(Sim::OwnOrderMsg))  {
+            const Sim::OwnOrderMsg* msg = reinterpret_cast<const Sim::OwnOrderMsg*>(packet_ptr);
+            slot->seqNum = std::byteswap(header->seqNum);
+            slot->id = std::byteswap(msg->id);
+            slot->instrumentId = std::byteswap(header->instrumentId);
+            slot->type = MsgType::OwnOrder;
+            return true;
+        }
 
         return false; //Unknown type or corrupted packet
     }
+
+    // Kept out of line so the accept path stays small.
+    [[gnu::noinline, gnu::cold]] bool reject(uint32_t mask) {
+        rejects.add(mask);
+        return false;
+    }
+
+public:
+    explicit SimParser(FeedSlice slice = feedSlice<ProfileT>()) : slice(slice) {}
+
+    inline bool parse(const char* packet_ptr, size_t len, QueueItem* slot) {
+        if (!decode(packet_ptr, len, slot)) [[unlikely]] {
+            return reject(rejectBit(RejectReason::Malformed));
+        }
+
+        uint32_t mask = rejectMask<ProfileT>(*slot);
+        mask |= static_cast<uint32_t>(slot->instrumentId >= slice.instrumentCount) * rejectBit(RejectReason::InvalidInstrument);
+
+        if (mask) [[unlikely]] {
+            return reject(mask);
+        }
+
+        // Ids past the slice land past the engine's id range, where the book ignores them
+        // like any other out-of-range id.
+        slot->instrumentId += slice.instrumentBase;
+        slot->id = slot->id < slice.idCount ? slice.idBase + slot->id : ProfileT::MAX_ORDER_IDS;
+        slot->feedId = slice.feedId;
+        return true;
+    }
+
+    // Decode only: no range checks, no slice mapping. Baseline for what validation costs.
+    inline bool parseUnchecked(const char* packet_ptr, size_t len, QueueItem* slot) {
+        return decode(packet_ptr, len, slot);
+    }
+
+    const RejectCounters& getRejects() const {
+        return rejects;
+    }
 };
\ No newline at end of file
@@ -10,7 +10,7 @@ namespace Sim {
     {
         uint64_t seqNum;
         uint16_t instrumentId;
-        MsgType type; // 'A' (Add), 'C' (Cancel), 'E' (Executed)
+        MsgType type; // 'A' (Add), 'C' (Cancel), 'E' (Executed), 'O' (Own order)
     };
 
     struct AddOrderMsg 
@@ -35,6 +35,31 @@ namespace Sim {
         uint32_t quantity;
     };
 
+    // Local execution-report stand-in, sent on the same feed ahead of (or after) the add.
+    // Its header seqNum counts reports only, apart from the feed sequence.
+    struct OwnOrderMsg
+    {
+        PacketHeader header;
+        uint64_t id;
+    };
+
+    // Snapshot channel (TCP): per instrument, a header followed by its resting orders in
+    // queue order. The server closes the connection after the last instrument.
+    struct SnapshotHeader
+    {
+        uint64_t seqNum; // last incremental reflected in this snapshot
+        uint16_t instrumentId;
+        uint32_t orderCount;
+    };
+
+    struct SnapshotOrder
+    {
+        uint64_t id;
+        int32_t price;
+        uint32_t quantity;
+        char side;
+    };
+
     #pragma pack(pop)
 
 } // namespace Sim
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <print>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Messages.h"
+#include "SimProtocol.h"
+
+// Full book of one instrument as of seqNum, orders in queue order, as AddOrder items.
+struct InstrumentSnapshot
+{
+    uint16_t instrumentId;
+    uint64_t seqNum;
+    std::vector<QueueItem> orders;
+};
+
+// Blocking one-shot client for the snapshot channel. Meant to run off the engine core
+// while the engine buffers live incrementals.
+class SnapshotClient {
+private:
+    // The engine buffers the live feed until we return: a hung server must not stall it forever.
+    static constexpr int TIMEOUT_SEC = 5;
+    static constexpr int DEADLINE_SEC = 30;
+
+    const char* host;
+    uint16_t port;
+
+    std::vector<char> data;
+
+    bool download() {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+
+        struct timeval tv; tv.tv_sec = TIMEOUT_SEC; tv.tv_usec = 0;
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, (const char*)&tv, sizeof tv);
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, (const char*)&tv, sizeof tv);
+
+        struct sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        inet_pton(AF_INET, host, &addr.sin_addr);
+
+        if (connect(fd, (const struct sockaddr*)&addr, sizeof(addr)) < 0) {
+            close(fd);
+            return false;
+        }
+
+        // The receive timeout bounds each recv; the deadline bounds a server trickling bytes.
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(DEADLINE_SEC);
+
+        char chunk[65536];
+        ssize_t n;
+        while ((n = recv(fd, chunk, sizeof(chunk), 0)) > 0) {
+            data.insert(data.end(), chunk, chunk + n);
+
+            if (std::chrono::steady_clock::now() > deadline) {
+                std::println(stderr, "[SNAPSHOT] Download exceeded {} s, giving up", DEADLINE_SEC);
+                n = -1;
+                break;
+            }
+        }
+
+        close(fd);
+        return n == 0;
+    }
+
+    template<typename WireT>
+    bool read(size_t& offset, WireT& out) const {
+        if (offset + sizeof(WireT) > data.size()) return false;
+        std::memcpy(&out, data.data() + offset, sizeof(WireT));
+        offset += sizeof(WireT);
+        return true;
+    }
+
+public:
+    SnapshotClient(const char* host, uint16_t port) : host(host), port(port) {}
+
+    // Empty on failure: the caller then starts from empty books as before.
+    std::vector<InstrumentSnapshot> fetch() {
+        std::vector<InstrumentSnapshot> snapshots;
+
+        if (!download()) {
+            std::println(stderr, "[SNAPSHOT] Cannot download snapshot from {}:{}", host, port);
+            return snapshots;
+        }
+
+        size_t offset = 0;
+        Sim::SnapshotHeader header;
+
+        while (read(offset, header)) {
+            InstrumentSnapshot& snap = snapshots.emplace_back();
+            snap.instrumentId = std::byteswap(header.instrumentId);
+            snap.seqNum = std::byteswap(header.seqNum);
+
+            uint32_t count = std::byteswap(header.orderCount);
+            snap.orders.reserve(count);
+
+            for (uint32_t i = 0; i < count; ++i) {
+                Sim::SnapshotOrder msg;
+                if (!read(offset, msg)) {
+                    std::println(stderr, "[SNAPSHOT] Truncated snapshot for instrument {}", snap.instrumentId);
+                    return {};
+                }
+
+                QueueItem& item = snap.orders.emplace_back();
+                item.seqNum = snap.seqNum;
+                item.id = std::byteswap(msg.id);
+                item.price = std::byteswap(msg.price);
+                item.quantity = std::byteswap(msg.quantity);
+                item.instrumentId = snap.instrumentId;
+                item.type = MsgType::AddOrder;
+                item.side = static_cast<Side>(msg.side);
+            }
+        }
+
+        return snapshots;
+    }
+};
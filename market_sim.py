@@ -1,76 +1,109 @@
 import socket
 import struct
+import threading
 import time
 import random
 
 MCAST_GRP = '127.0.0.1'
 MCAST_PORT = 1234
+SNAPSHOT_PORT = 1235
 
 sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
 
 NUM_INSTRUMENTS = 5
 
-# Keep track of live orders to enable cancellations
+# Keep track of live orders to enable cancellations (id -> [qty, price, side], in queue order)
 live_orders = {i: {} for i in range(0, NUM_INSTRUMENTS)} 
+book_lock = threading.Lock()
 current_prices = {i: random.randint(5000, 15000) for i in range(0, NUM_INSTRUMENTS)} # Price in cents (100.00)
 
 order_id_counter = 1
 seq_num = 1
+report_seq = 1 # execution reports ('O') are numbered apart from the feed
 
-print(f"Market simulator started on {MCAST_PORT} for {NUM_INSTRUMENTS} instruments...")
+
+# Stand-in snapshot server for late joiners: one TCP connection = one full snapshot
+def snapshot_server():
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(('127.0.0.1', SNAPSHOT_PORT))
+    server.listen()
+
+    while True:
+        conn, _ = server.accept()
+        with book_lock:
+            snapshot_seq = seq_num - 1
+            payload = b''
+            for instr, orders in live_orders.items():
+                payload += struct.pack('>QHI', snapshot_seq, instr, len(orders))
+                for oid, (qty, price, side) in orders.items():
+                    payload += struct.pack('>QiIc', oid, price, qty, side)
+        conn.sendall(payload)
+        conn.close()
+        print(f"Snapshot served at seq {snapshot_seq}")
+
+threading.Thread(target=snapshot_server, daemon=True).start()
+
+print(f"Market simulator started on {MCAST_PORT} for {NUM_INSTRUMENTS} instruments (snapshots on {SNAPSHOT_PORT})...")
 
 try:
     while True:
         burst_size = random.randint(10, 100)
         
-        for _ in range(burst_size):
-            instr_id = random.randint(0, NUM_INSTRUMENTS - 1)
-
-            move = random.choices([-5, 0, 5], weights=[0.3, 0.4, 0.3])[0]
-            current_prices[instr_id] += move
-            if current_prices[instr_id] < 100: current_prices[instr_id] = 100 # Price floor
-
-            msg_type = b'A'
-            if len(live_orders[instr_id]) > 0:
-                rand_val = random.random()
-                if rand_val < 0.15:
-                    msg_type = b'C' # 15% Cancel
-                elif rand_val < 0.35:
-                    msg_type = b'E' # 20% Execute
+        with book_lock:
+            for _ in range(burst_size):
+                instr_id = random.randint(0, NUM_INSTRUMENTS - 1)
+
+                move = random.choices([-5, 0, 5], weights=[0.3, 0.4, 0.3])[0]
+                current_prices[instr_id] += move
+                if current_prices[instr_id] < 100: current_prices[instr_id] = 100 # Price floor
+
+                msg_type = b'A'
+                if len(live_orders[instr_id]) > 0:
+                    rand_val = random.random()
+                    if rand_val < 0.15:
+                        msg_type = b'C' # 15% Cancel
+                    elif rand_val < 0.35:
+                        msg_type = b'E' # 20% Execute
             
-            packet = None
+                packet = None
             
-            if msg_type == b'A':
-                qty = random.randint(1, 100)
-                side = b'B' if random.random() > 0.5 else b'S'
+                if msg_type == b'A':
+                    qty = random.randint(1, 100)
+                    side = b'B' if random.random() > 0.5 else b'S'
                 
-                # Big-Endian : >
-                packet = struct.pack('>QHcQiIc', seq_num, instr_id, b'A', order_id_counter, current_prices[instr_id], qty, side)
-                live_orders[instr_id][order_id_counter] = qty
-                order_id_counter += 1
+                    # ~1% of adds are "ours": the execution report arrives ahead of the feed add.
+                    if random.random() < 0.01:
+                        sock.sendto(struct.pack('>QHcQ', report_seq, instr_id, b'O', order_id_counter), (MCAST_GRP, MCAST_PORT))
+                        report_seq += 1
+
+                    # Big-Endian : >
+                    packet = struct.pack('>QHcQiIc', seq_num, instr_id, b'A', order_id_counter, current_prices[instr_id], qty, side)
+                    live_orders[instr_id][order_id_counter] = [qty, current_prices[instr_id], side]
+                    order_id_counter += 1
                 
-            elif msg_type == b'C':
-                target_id = random.choice(list(live_orders[instr_id].keys()))
-                del live_orders[instr_id][target_id]
+                elif msg_type == b'C':
+                    target_id = random.choice(list(live_orders[instr_id].keys()))
+                    del live_orders[instr_id][target_id]
                 
-                packet = struct.pack('>QHcQ', seq_num, instr_id, b'C', target_id)
+                    packet = struct.pack('>QHcQ', seq_num, instr_id, b'C', target_id)
 
-            elif msg_type == b'E':
-                target_id = random.choice(list(live_orders[instr_id].keys()))
-                remaining_qty = live_orders[instr_id][target_id]
+                elif msg_type == b'E':
+                    target_id = random.choice(list(live_orders[instr_id].keys()))
+                    remaining_qty = live_orders[instr_id][target_id][0]
 
-                exec_qty = random.randint(1, remaining_qty)
-                live_orders[instr_id][target_id] -= exec_qty
+                    exec_qty = random.randint(1, remaining_qty)
+                    live_orders[instr_id][target_id][0] -= exec_qty
 
-                if live_orders[instr_id][target_id] <= 0:
-                    del live_orders[instr_id][target_id]
+                    if live_orders[instr_id][target_id][0] <= 0:
+                        del live_orders[instr_id][target_id]
 
-                packet = struct.pack('>QHcQI', seq_num, instr_id, b'E', target_id, exec_qty)
+                    packet = struct.pack('>QHcQI', seq_num, instr_id, b'E', target_id, exec_qty)
 
-            sock.sendto(packet, (MCAST_GRP, MCAST_PORT))
-            seq_num += 1
-            if seq_num % 10000 == 0:
-                print(f"Stats: {seq_num} msgs sent. Instr {instr_id} Price: {current_prices[instr_id]}")
+                sock.sendto(packet, (MCAST_GRP, MCAST_PORT))
+                seq_num += 1
+                if seq_num % 10000 == 0:
+                    print(f"Stats: {seq_num} msgs sent. Instr {instr_id} Price: {current_prices[instr_id]}")
 
         # --- PAUSE BETWEEN BURSTS ---
         # Sleep briefly (1ms to 10ms) to let the C++ consumer catch up
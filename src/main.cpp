@@ -1,41 +1,78 @@
+#include <csignal>
 #include <cstdlib>
 #include <emmintrin.h>
 #include <thread>
 #include <atomic>
+#include <array>
 #include <cstring>
+#include <memory>
 #include <print>
 #include <immintrin.h>
 
+#include "EngineConfig.h"
+#include "capture/CaptureReader.h"
+#include "capture/CaptureWriter.h"
+#include "LateJoin.h"
 #include "lob/Listeners.h"
 #include "lob/MarketManager.h"
+#include "lob/ShadowVerifier.h"
+#include "net/FeedScheduler.h"
 #include "net/NetworkProducer.h"
 #include "net/Receivers.h"
 #include "net/SimParser.h"
 #include "Messages.h"
 #include "RingBuffer.h"
+#include "MpscRingBuffer.h"
+#include "SharedRing.h"
 #include "TSCClock.h"
+#include "WaitStrategy.h"
+
+// Swap for UmwaitWait<> / FutexWait<> when the engine does not own its core.
+using EngineWait = BusySpinWait;
+using NetworkWait = BusySpinWait;
 
-constexpr size_t BUFFER_SIZE = 4096;
-RingBuffer<QueueItem, BUFFER_SIZE> ringBuffer;
 std::atomic<bool> running{true};
+static_assert(std::atomic<bool>::is_always_lock_free, "running is set from a signal handler");
+
+// SIGINT/SIGTERM: every loop sees `running` drop, so threads report (verifier summary,
+// rejects, capture tail) and join instead of dying mid-write.
+void stop(int) {
+    running.store(false, std::memory_order_relaxed);
+}
+
+// One recvmmsg burst
+constexpr size_t MAX_BATCH = 32;
 
-void consumer_thread()
+template<EngineProfileConcept ProfileT, typename RingT>
+void consumer_thread(RingT& ringBuffer, const RuntimeConfig& config, DigestTable<ProfileT::MAX_INSTRUMENTS>* digests)
 {
-    pin_to_core(5);
+    pin_to_core(config.engineCore);
     TSCClock::get().printCalibration();
     std::println("Engine started (waiting for data)...");
 
     EmptyListener listener;
-    MarketManager<EmptyListener> market(listener);
+    MarketManager<EmptyListener, ProfileT> market(listener);
+    market.setDigestTable(digests);
+    EngineWait wait;
+
+    SnapshotFilter snapshotFilter;
+    std::vector<QueueItem> fresh;
+
+    if (config.lateJoin) {
+        snapshotFilter = lateJoin<ProfileT>(ringBuffer, market, wait, SnapshotClient("127.0.0.1", config.snapshotPort),
+                                            feedSlice<ProfileT>(config.feedIndex, config.feedCount), MAX_BATCH);
+        fresh.reserve(MAX_BATCH);
+    }
 
-    // We store the latencies to print the percentiles later
+    // One sample per batch: the time to apply it. A mean per message would hide the tail.
     std::vector<uint64_t> samples;
     samples.reserve(100000);
+    uint64_t batchedItems = 0;
 
     uint64_t maxQueueDepth = 0;
 
-    // For packet loss
-    uint64_t lastSeqNum = 0;
+    // For packet loss, per feed: each feed numbers its own messages
+    std::array<uint64_t, MAX_FEEDS> lastSeqNum{};
     uint64_t gapCount = 0;
 
     unsigned int dummy;
@@ -46,74 +83,166 @@ void consumer_thread()
         size_t currentDepth = ringBuffer.getSize();
         if (currentDepth > maxQueueDepth) maxQueueDepth = currentDepth;
 
-        QueueItem* item = ringBuffer.peek();
-        if (item) 
+        std::span<QueueItem> batch = ringBuffer.peekBatch(MAX_BATCH);
+        if (!batch.empty()) 
         {
-            if(item->seqNum <= lastSeqNum)
+            wait.reset();
+
+            for (const QueueItem& item : batch)
             {
-                lastSeqNum = item->seqNum;
+                // Execution reports have their own sequence
+                if (item.type == MsgType::OwnOrder) continue;
+
+                uint64_t& last = lastSeqNum[item.feedId % MAX_FEEDS];
+                if(item.seqNum > last && last != 0 && item.seqNum != last + 1)
+                {
+                    gapCount += (item.seqNum -last -1);
+                }
+                last = item.seqNum;
             }
-            else if(lastSeqNum != 0 && item->seqNum != lastSeqNum + 1)
-            {
-                gapCount += (item->seqNum -lastSeqNum -1);
+
+            std::span<const QueueItem> items = batch;
+
+            // Only right after a late join: items the snapshot already holds.
+            if (snapshotFilter.active()) [[unlikely]] {
+                fresh.clear();
+                for (const QueueItem& item : batch) {
+                    if (!snapshotFilter.stale(item)) fresh.push_back(item);
+                }
+                items = fresh;
             }
-            lastSeqNum = item->seqNum;
 
             start_cycles = __rdtscp(&dummy);
             // --- CRITICAL ZONE ---
-            if(item->type == MsgType::AddOrder) {
-                market.onAddOrder(item->instrumentId, item->id, item->price, item->quantity, item->side);
-            }
-            else if (item->type == MsgType::CancelOrder) {
-                market.onCancelOrder(item->id);
-            }
-            else if (item->type == MsgType::ExecutedOrder) {
-                market.onOrderExecuted(item->id, item->quantity);
-            }
+            market.onBatch(items);
             // -----------------------------------------
 
             end_cycles = __rdtscp(&dummy);
 
-            ringBuffer.advance();
+            ringBuffer.advance(batch.size());
 
-            uint64_t cycles = end_cycles - start_cycles;
-            samples.push_back(cycles);
+            samples.push_back(end_cycles - start_cycles);
+            batchedItems += batch.size();
 
-            if (samples.size() > 100000) {
+            if (samples.size() == 100000) {
 
                 std::sort(samples.begin(), samples.end());
+                TSCClock::get().refine();
 
                 double p50 = TSCClock::get().toNanos(samples[50000]);
                 double p99 = TSCClock::get().toNanos(samples[99000]);
                 double maxLat = TSCClock::get().toNanos(samples.back());
 
-                std::println("--- STATS REPORT ---");
-                std::println("Lat p50   : {} ns", p50);
-                std::println("Lat p99   : {} ns", p99);
-                std::println("Lat Max   : {} ns", maxLat);
-                std::println("Queue Max : {} / {}", maxQueueDepth, BUFFER_SIZE);
+                std::println("--- STATS REPORT (per batch, {:.1f} msgs avg) ---", static_cast<double>(batchedItems) / samples.size());
+                std::println("Batch p50 : {} ns", p50);
+                std::println("Batch p99 : {} ns", p99);
+                std::println("Batch Max : {} ns", maxLat);
+                std::println("Queue Max : {} / {}", maxQueueDepth, ProfileT::RING_SIZE);
                 std::println("Packet Loss : {}", gapCount);
+                if constexpr (RingT::MULTI_PRODUCER) {
+                    std::println("Orphaned  : {}", ringBuffer.getOrphans());
+                }
 
                 samples.clear();
+                batchedItems = 0;
                 maxQueueDepth = 0;
             }
         } 
         else 
         {
-            _mm_pause();
+            wait.idle(ringBuffer);
         }
     }
 }
 
-int main(int argc, char* argv[])  {
-    std::string mode = "live";
-    if (argc > 1) {
-        mode = argv[1];
+// Builds the network side and hands it to `start`: a plain NetworkProducer for one feed,
+// a FeedScheduler when an auxiliary feed shares the core (polled every 16th round).
+// Each feed parses into its own slice of the engine.
+template<EngineProfileConcept ProfileT, typename RingT, typename StartT>
+void withProducer(RingT& ring, const RuntimeConfig& config, StartT&& start) {
+    SimParser<ProfileT> primaryParser(feedSlice<ProfileT>(config.feedIndex, config.feedCount));
+
+    if (config.auxPort == 0) {
+        NetworkProducer<SimParser<ProfileT>, UdpMulticastReceiver, RingT, NetworkWait> producer(ring, primaryParser, config.port);
+        start(producer);
+        return;
+    }
+
+    using PrimaryFeed = Feed<SimParser<ProfileT>, UdpMulticastReceiver, 0>;
+    using AuxFeed = Feed<SimParser<ProfileT>, UdpMulticastReceiver, 4>;
+
+    PrimaryFeed primary(primaryParser, config.port);
+    AuxFeed aux(SimParser<ProfileT>(feedSlice<ProfileT>(config.feedIndex + 1, config.feedCount)), config.auxPort);
+
+    FeedScheduler<RingT, NetworkWait, PrimaryFeed, AuxFeed> scheduler(ring, primary, aux);
+    start(scheduler);
+}
+
+// Feed and engine as separate processes. Several feeds (one per port) can attach to the
+// ring of one engine.
+template<EngineProfileConcept ProfileT>
+int runShared(const RuntimeConfig& config) {
+    using SharedRingT = MpscRingBuffer<QueueItem, ProfileT::RING_SIZE>;
+
+    if (config.mode == "engine") {
+        SharedRing<SharedRingT> shm(config.shmName, SharedRing<SharedRingT>::Mode::OpenOrCreate);
+        consumer_thread<ProfileT>(shm.get(), config, nullptr);
+        return 0;
+    }
+
+    if (config.mode == "feed") {
+        SharedRing<SharedRingT> shm(config.shmName, SharedRing<SharedRingT>::Mode::Attach);
+        std::println("=== Feed on port {} -> {} ===", config.port, config.shmName);
+        withProducer<ProfileT>(shm.get(), config, [&](auto& producer) { producer.run(config.networkCore); });
+        return 0;
+    }
+
+    std::println(stderr, "--shm needs mode 'feed' or 'engine'");
+    return EXIT_FAILURE;
+}
+
+// Rebuilds the books from a capture file as fast as it decodes.
+template<EngineProfileConcept ProfileT>
+int runReplay(const RuntimeConfig& config) {
+    if (config.capturePath.empty()) {
+        std::println(stderr, "replay needs --capture <file>");
+        return EXIT_FAILURE;
+    }
+
+    EmptyListener listener;
+    auto market = std::make_unique<MarketManager<EmptyListener, ProfileT>>(listener);
+
+    unsigned threads = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    std::println("=== Replaying {} on {} decode threads ===", config.capturePath, threads);
+
+    ReplayStats stats = replayCapture<ProfileT>(config.capturePath, *market, threads);
+
+    std::println("Events  : {} in {} blocks ({} corrupt, {} events rejected)", stats.events, stats.blocks, stats.corruptBlocks, stats.rejectedEvents);
+    std::println("Time    : {} s", stats.seconds);
+    std::println("Rate    : {} M events/s", stats.seconds > 0 ? stats.events / stats.seconds / 1e6 : 0.0);
+    return 0;
+}
+
+template<EngineProfileConcept ProfileT>
+int run(const RuntimeConfig& config) {
+    if (!config.shmName.empty()) {
+        return runShared<ProfileT>(config);
+    }
+    if (config.mode == "replay") {
+        return runReplay<ProfileT>(config);
     }
 
-    std::thread consumer(consumer_thread);
+    static RingBuffer<QueueItem, ProfileT::RING_SIZE> ringBuffer;
+    using RingT = decltype(ringBuffer);
+
+    // Shadow-book verification: the producer copies its output to a tap, the engine exports digests.
+    static RingT tapRing;
+    static DigestTable<ProfileT::MAX_INSTRUMENTS> digests;
+    static ShadowVerifier<ProfileT> verifier;
 
-    if (mode == "pcap") {
+    std::thread consumer([&] { consumer_thread<ProfileT>(ringBuffer, config, config.verify ? &digests : nullptr); });
+
+    if (config.mode == "pcap") {
         std::println("=== Starting in REPLAY mode (PCAP) ===");
         PcapReceiver pcapRecv("nasdaq_sample.pcap");
         // NetworkProducer<PcapReceiver> producer(pcapRecv);
@@ -121,10 +250,47 @@ int main(int argc, char* argv[])  {
     }
     else {
         std::println("=== Starting in LIVE mode (UDP Multicast) ===");
-        NetworkProducer<SimParser, UdpMulticastReceiver> producer(SimParser{}, 1234);
-        producer.run();
+        withProducer<ProfileT>(ringBuffer, config, [&](auto& producer) {
+            std::thread verifierThread;
+            if (config.verify) {
+                producer.setTap(&tapRing);
+                verifierThread = std::thread([&] { verifier.run(tapRing, digests, producer.getTapDrops(), config.verifierCore); });
+            }
+
+            std::thread captureThread;
+            if (!config.capturePath.empty()) {
+                producer.setTap(&tapRing);
+                captureThread = std::thread([&] {
+                    CaptureWriter<ProfileT> writer(config.capturePath);
+                    writer.run(tapRing, producer.getTapDrops(), config.captureCore);
+                });
+            }
+
+            producer.run(config.networkCore);
+
+            if (verifierThread.joinable()) verifierThread.join();
+            if (captureThread.joinable()) captureThread.join();
+        });
     }
         
     consumer.join();
     return 0;
 }
+
+int main(int argc, char* argv[])  {
+    RuntimeConfig config = parseRuntimeConfig(argc, argv);
+
+    struct sigaction sa{};
+    sa.sa_handler = stop;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+
+    TSCClock::get();
+
+    if (config.profile == "thin") {
+        std::println("=== Profile: thin venue ===");
+        return run<ThinVenueProfile>(config);
+    }
+    return run<BusyVenueProfile>(config);
+}
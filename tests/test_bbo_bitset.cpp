@@ -0,0 +1,71 @@
+#undef NDEBUG
+#include <cassert>
+#include <array>
+#include <climits>
+#include <iterator>
+#include <memory>
+#include <print>
+#include <random>
+#include <set>
+#include "lob/BboBitset.h"
+
+// BboBitset against a std::set of the same prices, plus the ends of the price range.
+
+constexpr int32_t MAX_PRICE = 20000;
+using Bitset = BboBitset<MAX_PRICE>;
+
+void pricesAboveTheGridClamp() {
+    auto bits = std::make_unique<Bitset>();
+    bits->setPrice(7);
+    bits->setPrice(MAX_PRICE);
+
+    assert(bits->nextLower(MAX_PRICE + 1) == MAX_PRICE);
+    assert(bits->nextLower(MAX_PRICE + 2) == MAX_PRICE);
+    assert(bits->nextLower(MAX_PRICE + 100000) == MAX_PRICE);
+    assert(bits->nextLower(INT_MAX) == MAX_PRICE);
+    assert(bits->nextLower(MAX_PRICE) == 7);
+    assert(bits->nextLower(7) == Bitset::NONE);
+
+    bits->clearPrice(MAX_PRICE);
+    assert(bits->nextLower(INT_MAX) == 7);
+
+    assert(bits->nextHigher(MAX_PRICE) == Bitset::NONE);
+    assert(bits->nextHigher(INT_MAX - 1) == Bitset::NONE);
+}
+
+void matchesReference() {
+    auto bits = std::make_unique<Bitset>();
+    std::set<int32_t> ref;
+    std::mt19937 rng(7);
+
+    for (int i = 0; i < 200000; ++i) {
+        auto price = static_cast<int32_t>(rng() % (MAX_PRICE + 1));
+        if (rng() & 1) {
+            bits->setPrice(price);
+            ref.insert(price);
+        }
+        else {
+            bits->clearPrice(price);
+            ref.erase(price);
+        }
+
+        auto probe = static_cast<int32_t>(rng() % (MAX_PRICE + 64));
+
+        auto above = ref.upper_bound(probe);
+        assert(bits->nextHigher(probe) == (above == ref.end() ? Bitset::NONE : *above));
+
+        auto below = ref.lower_bound(probe);
+        assert(bits->nextLower(probe) == (below == ref.begin() ? Bitset::NONE : *std::prev(below)));
+    }
+
+    std::array<int32_t, 10> out;
+    size_t n = bits->top<Side::Buy>(out);
+    auto it = ref.rbegin();
+    for (size_t i = 0; i < n; ++i, ++it) assert(out[i] == *it);
+}
+
+int main() {
+    pricesAboveTheGridClamp();
+    matchesReference();
+    std::println("test_bbo_bitset: ok");
+}
@@ -0,0 +1,96 @@
+#undef NDEBUG
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <print>
+#include <vector>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "MpscRingBuffer.h"
+
+// Producers in other processes can die at any point. A producer killed between claim()
+// and publish() must not wedge the consumer; a live but slow one must not be skipped.
+
+using Ring = MpscRingBuffer<uint64_t, 64>;
+
+Ring* sharedRing() {
+    void* mem = mmap(nullptr, sizeof(Ring), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    assert(mem != MAP_FAILED);
+    return new (mem) Ring();
+}
+
+void producerKilledMidClaim() {
+    Ring& ring = *sharedRing();
+
+    pid_t child = fork();
+    if (child == 0) {
+        ring.push(1);
+        ring.push(2);
+        *ring.claim() = 99;
+        kill(getpid(), SIGKILL);
+    }
+    int status;
+    waitpid(child, &status, 0);
+    assert(WIFSIGNALED(status));
+
+    // A restarted feed carries on behind the dead one's slot.
+    ring.push(3);
+    ring.push(4);
+
+    std::vector<uint64_t> items;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (items.size() < 4 && std::chrono::steady_clock::now() < deadline) {
+        std::span<uint64_t> batch = ring.peekBatch(8);
+        items.insert(items.end(), batch.begin(), batch.end());
+        ring.advance(batch.size());
+    }
+
+    assert((items == std::vector<uint64_t>{1, 2, 3, 4}));
+    assert(ring.getOrphans() == 1);
+
+    // The skipped slot is reusable on the next lap.
+    for (uint64_t i = 0; i < 200; ++i) {
+        assert(ring.push(i));
+        uint64_t out;
+        assert(ring.pop(out) && out == i);
+    }
+}
+
+void slowProducerIsNotSkipped() {
+    Ring& ring = *sharedRing();
+
+    uint64_t* slot = ring.claim();
+    *slot = 7;
+
+    auto until = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (std::chrono::steady_clock::now() < until) {
+        assert(ring.peekBatch(8).empty());
+    }
+    assert(ring.getOrphans() == 0);
+
+    ring.publish(slot);
+    uint64_t out;
+    assert(ring.pop(out) && out == 7);
+}
+
+void restartChecksTheRing() {
+    Ring& ring = *sharedRing();
+
+    ring.push(1);
+    uint64_t* inFlight = ring.claim();
+    assert(ring.recoverConsumer());
+
+    ring.publish(inFlight);
+    assert(ring.recoverConsumer());
+    assert(ring.getSize() == 2);
+}
+
+int main() {
+    producerKilledMidClaim();
+    slowProducerIsNotSkipped();
+    restartChecksTheRing();
+    std::println("test_mpsc_crash: ok");
+}
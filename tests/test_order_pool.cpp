@@ -0,0 +1,58 @@
+#undef NDEBUG
+#include <cassert>
+#include <print>
+#include "lob/OrderPool.h"
+#include "lob/PassiveOrderBook.h"
+
+// OrderPool::get() reassembles an Order from the links and info arrays: it must see
+// every change the book makes through either of them.
+
+constexpr int32_t MAX_PRICE = 1000;
+
+void expectOrder(const Order& o, uint64_t id, int32_t price, uint32_t qty, Side side, uint16_t instr, int32_t prev, int32_t next) {
+    assert(o.id == id);
+    assert(o.price == price);
+    assert(o.quantity == qty);
+    assert(o.side == side);
+    assert(o.instrumentId == instr);
+    assert(o.prev == prev);
+    assert(o.next == next);
+}
+
+int main() {
+    OrderPool pool(8);
+    PassiveOrderBook<MAX_PRICE> book;
+
+    // Three orders queued at one level.
+    int32_t a = pool.allocate(10, 500, 5, Side::Buy, 3);
+    int32_t b = pool.allocate(11, 500, 7, Side::Buy, 3);
+    int32_t c = pool.allocate(12, 500, 9, Side::Buy, 3);
+    book.addOrder(a, Side::Buy, pool);
+    book.addOrder(b, Side::Buy, pool);
+    book.addOrder(c, Side::Buy, pool);
+
+    expectOrder(pool.get(a), 10, 500, 5, Side::Buy, 3, -1, b);
+    expectOrder(pool.get(b), 11, 500, 7, Side::Buy, 3, a, c);
+    expectOrder(pool.get(c), 12, 500, 9, Side::Buy, 3, b, -1);
+
+    // Partial execution of the middle one.
+    pool.link(b).quantity -= 4;
+    book.reduceVolume(Side::Buy, 500, 4);
+    expectOrder(pool.get(b), 11, 500, 3, Side::Buy, 3, a, c);
+    assert(book.getVolume(Side::Buy, 500) == 17);
+
+    // Cancel it: the neighbours link to each other.
+    book.reduceVolume(Side::Buy, 500, pool.link(b).quantity);
+    book.removeOrder(b, Side::Buy, pool);
+    pool.deallocate(b);
+    expectOrder(pool.get(a), 10, 500, 5, Side::Buy, 3, -1, c);
+    expectOrder(pool.get(c), 12, 500, 9, Side::Buy, 3, a, -1);
+
+    // The freed slot comes back clean for a different order.
+    int32_t d = pool.allocate(20, 600, 2, Side::Sell, 1);
+    assert(d == b);
+    expectOrder(pool.get(d), 20, 600, 2, Side::Sell, 1, -1, -1);
+    assert(!pool.info(d).own);
+
+    std::println("test_order_pool: ok");
+}
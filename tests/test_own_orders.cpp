@@ -0,0 +1,125 @@
+#undef NDEBUG
+#include <cassert>
+#include <memory>
+#include <print>
+#include <random>
+#include <unordered_map>
+#include "EngineConfig.h"
+#include "lob/Listeners.h"
+#include "lob/MarketManager.h"
+#include "lob/OwnOrderTracker.h"
+
+// The tracker runs on the engine core with fixed storage: the id maps have to stay exact
+// under churn, and queue positions have to survive orders coming and going around ours.
+
+using Profile = ThinVenueProfile;
+using Market = MarketManager<EmptyListener, Profile>;
+
+void idMapMatchesUnorderedMap() {
+    FixedIdMap map(512);
+    std::unordered_map<uint64_t, uint64_t> reference;
+    std::mt19937_64 rng(7);
+
+    for (int i = 0; i < 200'000; ++i) {
+        uint64_t key = rng() % 2048;
+        switch (rng() % 3) {
+            case 0:
+                if (reference.size() < 512 || reference.contains(key)) {
+                    assert(map.insert(key, i));
+                    reference[key] = i;
+                }
+                else {
+                    assert(!map.insert(key, i));
+                }
+                break;
+            case 1:
+                assert(map.erase(key) == (reference.erase(key) != 0));
+                break;
+            default: {
+                const uint64_t* v = map.find(key);
+                auto it = reference.find(key);
+                assert((v != nullptr) == (it != reference.end()));
+                if (v) assert(*v == it->second);
+            }
+        }
+        assert(map.size() == reference.size());
+    }
+
+    map.eraseIf([](uint64_t key, uint64_t) { return key % 2 == 0; });
+    std::erase_if(reference, [](const auto& e) { return e.first % 2 == 0; });
+    assert(map.size() == reference.size());
+    for (const auto& [key, value] : reference) assert(map.find(key) && *map.find(key) == value);
+}
+
+void queuePositionFollowsTheLevel() {
+    EmptyListener listener;
+    auto market = std::make_unique<Market>(listener);
+
+    market->onAddOrder(0, 1, 100, 10, Side::Buy);
+    market->registerOwnOrder(2, 1); // report ahead of the feed add
+    market->onAddOrder(0, 2, 100, 5, Side::Buy);
+    market->onAddOrder(0, 3, 100, 7, Side::Buy);
+    market->onAddOrder(0, 4, 100, 3, Side::Buy);
+    market->registerOwnOrder(4, 2); // already resting
+
+    assert(market->getOwnOrderCount() == 2);
+    assert(market->getVolumeAhead(2) == 10);
+    assert(market->getVolumeAhead(4) == 22);
+
+    market->onOrderExecuted(1, 4);
+    assert(market->getVolumeAhead(2) == 6);
+    assert(market->getVolumeAhead(4) == 18);
+
+    market->onCancelOrder(3);
+    assert(market->getVolumeAhead(2) == 6);
+    assert(market->getVolumeAhead(4) == 11);
+
+    market->onOrderExecuted(1, 6);
+    market->onOrderExecuted(2, 5);
+    assert(market->getOwnOrderCount() == 1);
+    assert(!market->getVolumeAhead(2));
+    assert(market->getVolumeAhead(4) == 0);
+
+    market->onCancelOrder(4);
+    assert(market->getOwnOrderCount() == 0);
+}
+
+void capacityIsBounded() {
+    EmptyListener listener;
+    auto market = std::make_unique<Market>(listener);
+    constexpr uint64_t N = Profile::MAX_OWN_ORDERS;
+
+    for (uint64_t id = 0; id < N + 10; ++id) {
+        market->onAddOrder(1, id, 200 + static_cast<int32_t>(id % 50), 1, Side::Sell);
+        market->registerOwnOrder(id, id + 1);
+    }
+    assert(market->getOwnOrderCount() == N);
+    assert(!market->getVolumeAhead(N + 5));
+
+    // Freed slots are reused.
+    market->onCancelOrder(0);
+    market->onAddOrder(1, N + 20, 300, 1, Side::Sell);
+    market->registerOwnOrder(N + 20, N + 21);
+    assert(market->getOwnOrderCount() == N);
+    assert(market->getVolumeAhead(N + 20) == 0);
+}
+
+void pendingReportsExpire() {
+    OwnOrderTracker tracker(1, 100, 4);
+
+    for (uint64_t id = 0; id < 4; ++id) assert(tracker.expect(id, id + 1));
+    assert(!tracker.expect(10, 5)); // full, nothing old enough
+
+    // Far enough past the first reports: they are dropped to make room.
+    assert(tracker.expect(11, (1 << 16) + 10));
+    assert(!tracker.claimPending(0));
+    assert(tracker.claimPending(11));
+}
+
+int main() {
+    idMapMatchesUnorderedMap();
+    queuePositionFollowsTheLevel();
+    capacityIsBounded();
+    pendingReportsExpire();
+    std::println("test_own_orders: ok");
+}
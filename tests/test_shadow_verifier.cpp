@@ -0,0 +1,94 @@
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <memory>
+#include <print>
+#include <vector>
+#include "EngineConfig.h"
+#include "lob/Listeners.h"
+#include "lob/MarketManager.h"
+#include "lob/ShadowVerifier.h"
+
+// The verifier has to catch a book that differs below the touch, where the digest only
+// carries the per-side level hash.
+
+std::atomic<bool> running{true};
+
+using Profile = ThinVenueProfile;
+
+QueueItem add(uint64_t seqNum, uint64_t id, int32_t price, uint32_t qty, Side side) {
+    QueueItem item{};
+    item.seqNum = seqNum;
+    item.id = id;
+    item.price = price;
+    item.quantity = qty;
+    item.type = MsgType::AddOrder;
+    item.side = side;
+    return item;
+}
+
+struct Setup {
+    EmptyListener listener;
+    std::unique_ptr<MarketManager<EmptyListener, Profile>> market = std::make_unique<MarketManager<EmptyListener, Profile>>(listener);
+    std::unique_ptr<DigestTable<Profile::MAX_INSTRUMENTS>> digests = std::make_unique<DigestTable<Profile::MAX_INSTRUMENTS>>();
+    ShadowVerifier<Profile> verifier;
+
+    Setup() { market->setDigestTable(digests.get()); }
+
+    // A two-sided book: touch at 100 / 101, deeper bids down to 95.
+    std::vector<QueueItem> book() {
+        std::vector<QueueItem> items;
+        uint64_t seq = 1;
+        for (int32_t p = 95; p <= 100; ++p, ++seq) items.push_back(add(seq, seq, p, 10, Side::Buy));
+        for (int32_t p = 101; p <= 105; ++p, ++seq) items.push_back(add(seq, seq, p, 10, Side::Sell));
+        return items;
+    }
+
+    void run(const std::vector<QueueItem>& engine, const std::vector<QueueItem>& reference) {
+        market->onBatch(engine);
+        for (const QueueItem& item : reference) verifier.apply(item);
+        verifier.verify(*digests);
+    }
+};
+
+void identicalBooksMatch() {
+    Setup s;
+    std::vector<QueueItem> items = s.book();
+    items.push_back(QueueItem{.seqNum = 12, .id = 3, .quantity = 4, .type = MsgType::ExecutedOrder});
+
+    s.run(items, items);
+    assert(s.verifier.getMismatches() == 0);
+}
+
+void deepVolumeMismatch() {
+    Setup s;
+    std::vector<QueueItem> engine = s.book();
+    std::vector<QueueItem> reference = engine;
+
+    // Bid at 96 is two levels below the touch.
+    engine[1].quantity = 11;
+
+    s.run(engine, reference);
+    assert(s.verifier.getMismatches() == 1);
+}
+
+void deepOrderCountMismatch() {
+    Setup s;
+    std::vector<QueueItem> engine = s.book();
+    std::vector<QueueItem> reference = engine;
+
+    // Same volume at 97, one order against two.
+    engine.push_back(add(12, 100, 97, 4, Side::Buy));
+    engine.push_back(add(13, 101, 97, 6, Side::Buy));
+    reference.push_back(add(13, 100, 97, 10, Side::Buy));
+
+    s.run(engine, reference);
+    assert(s.verifier.getMismatches() == 1);
+}
+
+int main() {
+    identicalBooksMatch();
+    deepVolumeMismatch();
+    deepOrderCountMismatch();
+    std::println("test_shadow_verifier: ok");
+}
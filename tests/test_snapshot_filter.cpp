@@ -0,0 +1,65 @@
+#undef NDEBUG
+#include <atomic>
+#include <cassert>
+#include <print>
+#include "LateJoin.h"
+
+std::atomic<bool> running{true};
+
+// After a late join the engine copies every batch through the filter while it is
+// active, so it has to close even when some snapshotted instrument never trades again.
+
+QueueItem item(uint8_t feed, uint16_t instr, uint64_t seqNum) {
+    QueueItem q{};
+    q.feedId = feed;
+    q.instrumentId = instr;
+    q.seqNum = seqNum;
+    return q;
+}
+
+void staleItemsAreDropped() {
+    SnapshotFilter filter(1);
+    filter.set(10, 100);
+    filter.set(11, 120);
+
+    assert(filter.active());
+    assert(filter.stale(item(1, 10, 90)));
+    assert(filter.stale(item(1, 10, 100)));
+    assert(!filter.stale(item(1, 10, 101)));
+    assert(filter.stale(item(1, 11, 110)));
+
+    // Instruments without a snapshot pass through.
+    assert(!filter.stale(item(1, 12, 50)));
+    assert(filter.active());
+}
+
+void quietInstrumentDoesNotKeepItOpen() {
+    SnapshotFilter filter(1);
+    filter.set(10, 100);
+    filter.set(11, 120); // never updated again
+
+    assert(!filter.stale(item(1, 10, 115)));
+    assert(filter.active());
+
+    // Past the newest snapshot on the snapshot feed: nothing can be stale any more.
+    assert(!filter.stale(item(1, 10, 121)));
+    assert(!filter.active());
+    assert(!filter.stale(item(1, 11, 119)));
+}
+
+void otherFeedsDoNotClose() {
+    SnapshotFilter filter(1);
+    filter.set(10, 100);
+
+    // Another feed's seqNums are a different sequence.
+    assert(!filter.stale(item(2, 40, 5000)));
+    assert(filter.active());
+    assert(filter.stale(item(1, 10, 99)));
+}
+
+int main() {
+    staleItemsAreDropped();
+    quietInstrumentDoesNotKeepItOpen();
+    otherFeedsDoNotClose();
+    std::println("test_snapshot_filter: ok");
+}
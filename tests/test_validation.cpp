@@ -0,0 +1,117 @@
+#undef NDEBUG
+#include <cassert>
+#include <memory>
+#include <print>
+#include "EngineConfig.h"
+#include "Validation.h"
+#include "lob/BookDigest.h"
+#include "lob/Listeners.h"
+#include "lob/MarketManager.h"
+
+// rejectMask is all that stands between feed bytes and the book arrays. Prices index the
+// level arrays, and both ends of the grid are sentinels: 0 is the empty bid, MAX_PRICE
+// the empty ask.
+
+using Profile = ThinVenueProfile;
+using Market = MarketManager<EmptyListener, Profile>;
+
+QueueItem add(int32_t price, uint32_t qty = 10, Side side = Side::Buy) {
+    QueueItem item{};
+    item.type = MsgType::AddOrder;
+    item.price = price;
+    item.quantity = qty;
+    item.side = side;
+    return item;
+}
+
+void priceBoundaries() {
+    const uint32_t badPrice = rejectBit(RejectReason::InvalidPrice);
+
+    assert(rejectMask<Profile>(add(1)) == 0);
+    assert(rejectMask<Profile>(add(Profile::MAX_PRICE - 1, 10, Side::Sell)) == 0);
+
+    assert(rejectMask<Profile>(add(0)) == badPrice);
+    assert(rejectMask<Profile>(add(Profile::MAX_PRICE, 10, Side::Sell)) == badPrice);
+    assert(rejectMask<Profile>(add(Profile::MAX_PRICE + 1)) == badPrice);
+    assert(rejectMask<Profile>(add(-1)) == badPrice);
+    assert(rejectMask<Profile>(add(INT32_MIN)) == badPrice);
+
+    // Only adds carry a price.
+    QueueItem cancel{};
+    cancel.type = MsgType::CancelOrder;
+    cancel.price = Profile::MAX_PRICE;
+    assert(rejectMask<Profile>(cancel) == 0);
+}
+
+void otherFields() {
+    assert(rejectMask<Profile>(add(100, 0)) == rejectBit(RejectReason::InvalidQuantity));
+    assert(rejectMask<Profile>(add(100, 10, static_cast<Side>('X'))) == rejectBit(RejectReason::InvalidSide));
+
+    QueueItem item = add(0, 0);
+    item.instrumentId = Profile::MAX_INSTRUMENTS;
+    assert(rejectMask<Profile>(item) == (rejectBit(RejectReason::InvalidInstrument) | rejectBit(RejectReason::InvalidPrice) |
+                                         rejectBit(RejectReason::InvalidQuantity)));
+}
+
+// The fuzzer reuses one engine across inputs: after reset() it must behave as new.
+void resetRestoresAFreshEngine() {
+    EmptyListener listener;
+    auto used = std::make_unique<Market>(listener);
+    auto fresh = std::make_unique<Market>(listener);
+    DigestTable<Profile::MAX_INSTRUMENTS> usedDigests, freshDigests;
+    used->setDigestTable(&usedDigests);
+    fresh->setDigestTable(&freshDigests);
+
+    for (uint64_t id = 0; id < 100; ++id) {
+        used->onAddOrder(static_cast<uint16_t>(id % 3), id, 1 + static_cast<int32_t>(id % (Profile::MAX_PRICE - 1)), 5,
+                         id % 2 ? Side::Buy : Side::Sell);
+    }
+    used->registerOwnOrder(7, 1);
+    used->registerOwnOrder(200, 2); // pending: must not survive the reset
+    used->onOrderExecuted(3, 2);
+    used->reset();
+
+    assert(used->getOwnOrderCount() == 0);
+    for (uint16_t instr = 0; instr < 3; ++instr) {
+        BookAnalytics a = used->getAnalytics(instr);
+        assert(a.bestBid == 0 && a.bestAsk == Profile::MAX_PRICE && a.vwap == 0);
+    }
+
+    // Same input, same books, own orders and digests.
+    std::vector<QueueItem> items;
+    for (uint64_t id = 0; id < 50; ++id) {
+        QueueItem item = add(500 + static_cast<int32_t>(id % 7), 3, id % 2 ? Side::Buy : Side::Sell);
+        item.id = id;
+        item.seqNum = id + 1;
+        items.push_back(item);
+    }
+    QueueItem own{};
+    own.type = MsgType::OwnOrder;
+    own.id = 5000;
+    own.seqNum = 1;
+    items.push_back(own);
+    items.push_back(add(500));
+    items.back().id = 5000;
+    items.push_back(add(501));
+    items.back().id = 200;
+
+    used->onBatch(items);
+    fresh->onBatch(items);
+
+    assert(used->getOwnOrderCount() == 1 && fresh->getOwnOrderCount() == 1);
+    assert(used->getVolumeAhead(5000) == fresh->getVolumeAhead(5000));
+    for (uint16_t instr = 0; instr < 3; ++instr) {
+        BookDigest a{}, b{};
+        bool readA = usedDigests.read(instr, a);
+        bool readB = freshDigests.read(instr, b);
+        assert(readA == readB);
+        assert(a.bidHash == b.bidHash && a.askHash == b.askHash && a.bestBid == b.bestBid && a.bestAsk == b.bestAsk);
+    }
+}
+
+int main() {
+    priceBoundaries();
+    otherFields();
+    resetRestoresAFreshEngine();
+    std::println("test_validation: ok");
+}